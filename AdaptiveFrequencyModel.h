@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <stdexcept>
+
+class AdaptiveFrequencyModel
+{
+public:
+    AdaptiveFrequencyModel(const uint32_t symbolsCount, const uint32_t increment, const uint32_t maxTotalFrequency);
+
+    uint32_t AddSymbol();
+    uint32_t GetSymbolsCount() const { return symbolsCount; }
+    uint32_t GetTotalFrequency() const { return totalFrequency; }
+    uint32_t GetFrequency(const uint32_t symbol) const { return frequencies[symbol]; }
+    uint32_t GetCumulativeFrequency(const uint32_t symbol) const;
+    uint32_t FindSymbol(const uint32_t target) const;
+    void Update(const uint32_t symbol);
+private:
+    const static uint32_t maxSymbolsCount = 1 << 22;
+
+    uint32_t symbolsCount;
+    uint32_t capacity;
+    uint32_t totalFrequency;
+    uint32_t increment;
+    uint32_t maxTotalFrequency;
+    std::vector<uint32_t> frequencies;
+    std::vector<uint32_t> tree;
+
+    void rebuild();
+};
+
+inline AdaptiveFrequencyModel::AdaptiveFrequencyModel(const uint32_t symbolsCount, const uint32_t increment, const uint32_t maxTotalFrequency) :
+    symbolsCount(symbolsCount), capacity(1), totalFrequency(symbolsCount), increment(increment), maxTotalFrequency(maxTotalFrequency)
+{
+    while (capacity < symbolsCount) capacity <<= 1;
+    frequencies.assign(capacity, 0);
+    for (uint32_t i = 0; i < symbolsCount; ++i) {
+        frequencies[i] = 1;
+    }
+    rebuild();
+}
+
+inline uint32_t AdaptiveFrequencyModel::AddSymbol()
+{
+    if (symbolsCount == maxSymbolsCount) {
+        throw std::runtime_error("AdaptiveFrequencyModel error: too many symbols");
+    }
+    if (symbolsCount == capacity) {
+        capacity <<= 1;
+        frequencies.resize(capacity, 0);
+        rebuild();
+    }
+    return symbolsCount++;
+}
+
+inline uint32_t AdaptiveFrequencyModel::GetCumulativeFrequency(const uint32_t symbol) const
+{
+    uint32_t cumulativeFrequency = 0;
+    for (uint32_t i = symbol; i > 0; i &= i - 1) {
+        cumulativeFrequency += tree[i];
+    }
+    return cumulativeFrequency;
+}
+
+inline uint32_t AdaptiveFrequencyModel::FindSymbol(const uint32_t target) const
+{
+    uint32_t position = 0, remaining = target;
+    for (uint32_t step = capacity; step > 0; step >>= 1) {
+        if ((position + step <= capacity) && (tree[position + step] <= remaining)) {
+            position += step;
+            remaining -= tree[position];
+        }
+    }
+    if (position >= symbolsCount) {
+        throw std::runtime_error("AdaptiveFrequencyModel error: target is out of range");
+    }
+    return position;
+}
+
+inline void AdaptiveFrequencyModel::Update(const uint32_t symbol)
+{
+    frequencies[symbol] += increment;
+    totalFrequency += increment;
+    for (uint32_t i = symbol + 1; i <= capacity; i += i & (0 - i)) {
+        tree[i] += increment;
+    }
+
+    if ((totalFrequency > maxTotalFrequency) && (totalFrequency > 4 * symbolsCount)) {
+        totalFrequency = 0;
+        for (uint32_t& frequency : frequencies) {
+            frequency = (frequency + 1) / 2;
+            totalFrequency += frequency;
+        }
+        rebuild();
+    }
+}
+
+inline void AdaptiveFrequencyModel::rebuild()
+{
+    tree.assign(capacity + 1, 0);
+    for (uint32_t i = 1; i <= capacity; ++i) {
+        tree[i] += frequencies[i - 1];
+        const uint32_t parent = i + (i & (0 - i));
+        if (parent <= capacity) tree[parent] += tree[i];
+    }
+}
\ No newline at end of file
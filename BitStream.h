@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+
+#include "../helpers/BitArray.h"
+
+class BitStream
+{
+public:
+    static void AppendBits(BitArray& bits, const uint64_t value, const uint32_t count);
+    static void AppendGamma(BitArray& bits, const uint64_t value);
+    static void Append(BitArray& bits, const BitArray& other);
+private:
+    BitStream() = default;
+};
+
+class BitReader
+{
+public:
+    explicit BitReader(std::ifstream& inputFile) : inputFile(inputFile), bitPointer(8) {}
+
+    char ReadBit();
+    uint64_t ReadBits(const uint32_t count);
+    uint64_t ReadGamma();
+private:
+    std::ifstream& inputFile;
+    BitArray bitBuffer;
+    size_t bitPointer;
+};
+
+inline void BitStream::AppendBits(BitArray& bits, const uint64_t value, const uint32_t count)
+{
+    for (uint32_t i = count; i-- > 0;) {
+        bits.push_back(((value >> i) & 1) ? '1' : '0');
+    }
+}
+
+inline void BitStream::AppendGamma(BitArray& bits, const uint64_t value)
+{
+    if (value < 1) {
+        throw std::runtime_error("BitStream error: gamma code is defined for positive numbers only");
+    }
+
+    uint32_t highestBit = 0;
+    while ((value >> highestBit) > 1) ++highestBit;
+
+    AppendBits(bits, 0, highestBit);
+    AppendBits(bits, value, highestBit + 1);
+}
+
+inline void BitStream::Append(BitArray& bits, const BitArray& other)
+{
+    for (size_t i = 0; i < other.size(); ++i) {
+        bits.push_back(other.get_bit(i));
+    }
+}
+
+inline char BitReader::ReadBit()
+{
+    if (bitPointer == 8) {
+        bitBuffer = BitArray::from_file(inputFile, 8);
+        bitPointer = 0;
+    }
+    return bitBuffer.get_bit(bitPointer++);
+}
+
+inline uint64_t BitReader::ReadBits(const uint32_t count)
+{
+    uint64_t value = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        value = (value << 1) | (ReadBit() == '1' ? 1 : 0);
+    }
+    return value;
+}
+
+inline uint64_t BitReader::ReadGamma()
+{
+    uint32_t highestBit = 0;
+    while (ReadBit() == '0') {
+        if (++highestBit > 63) {
+            throw std::runtime_error("BitReader error: invalid gamma code");
+        }
+    }
+    return (uint64_t(1) << highestBit) | ReadBits(highestBit);
+}
\ No newline at end of file
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <array>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#if defined(__SSE4_2__)
+#define CRC32C_HARDWARE_ALWAYS
+#include <nmmintrin.h>
+#elif defined(__GNUC__)
+#define CRC32C_HARDWARE_DISPATCH
+#include <nmmintrin.h>
+#endif
+#endif
+
+class CRC32C
+{
+public:
+    static uint32_t Compute(const void* data, const size_t length, const uint32_t previous = 0);
+private:
+    CRC32C() = default;
+
+    const static uint32_t polynomial = 0x82F63B78;
+
+    using tables = std::array<std::array<uint32_t, 256>, 8>;
+
+    static const tables& getTables();
+    static uint32_t computeSoftware(const uint8_t* bytes, size_t length, uint32_t crc);
+#if defined(CRC32C_HARDWARE_ALWAYS) || defined(CRC32C_HARDWARE_DISPATCH)
+    static uint32_t computeHardware(const uint8_t* bytes, size_t length, uint32_t crc);
+#endif
+};
+
+inline uint32_t CRC32C::Compute(const void* data, const size_t length, const uint32_t previous)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+#if defined(CRC32C_HARDWARE_ALWAYS)
+    return ~computeHardware(bytes, length, ~previous);
+#elif defined(CRC32C_HARDWARE_DISPATCH)
+    static const bool hardware = __builtin_cpu_supports("sse4.2");
+    return ~(hardware ? computeHardware(bytes, length, ~previous) : computeSoftware(bytes, length, ~previous));
+#else
+    return ~computeSoftware(bytes, length, ~previous);
+#endif
+}
+
+inline const CRC32C::tables& CRC32C::getTables()
+{
+    static const tables table = []() {
+        tables result{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc >> 1) ^ ((crc & 1) ? polynomial : 0);
+            }
+            result[0][i] = crc;
+        }
+        for (uint32_t i = 0; i < 256; ++i) {
+            for (size_t k = 1; k < result.size(); ++k) {
+                result[k][i] = (result[k - 1][i] >> 8) ^ result[0][result[k - 1][i] & 0xFF];
+            }
+        }
+        return result;
+    }();
+    return table;
+}
+
+inline uint32_t CRC32C::computeSoftware(const uint8_t* bytes, size_t length, uint32_t crc)
+{
+    const tables& table = getTables();
+    for (; length >= 8; bytes += 8, length -= 8) {
+        uint32_t low, high;
+        std::memcpy(&low, bytes, sizeof(uint32_t));
+        std::memcpy(&high, bytes + 4, sizeof(uint32_t));
+        low ^= crc;
+        crc = table[7][low & 0xFF] ^ table[6][(low >> 8) & 0xFF] ^ table[5][(low >> 16) & 0xFF] ^ table[4][low >> 24] ^
+              table[3][high & 0xFF] ^ table[2][(high >> 8) & 0xFF] ^ table[1][(high >> 16) & 0xFF] ^ table[0][high >> 24];
+    }
+    for (; length > 0; ++bytes, --length) {
+        crc = (crc >> 8) ^ table[0][(crc ^ *bytes) & 0xFF];
+    }
+    return crc;
+}
+
+#if defined(CRC32C_HARDWARE_ALWAYS) || defined(CRC32C_HARDWARE_DISPATCH)
+#if defined(CRC32C_HARDWARE_DISPATCH)
+__attribute__((target("sse4.2")))
+#endif
+inline uint32_t CRC32C::computeHardware(const uint8_t* bytes, size_t length, uint32_t crc)
+{
+#if defined(__x86_64__) || defined(_M_X64)
+    uint64_t wide = crc;
+    for (; length >= 8; bytes += 8, length -= 8) {
+        uint64_t word;
+        std::memcpy(&word, bytes, sizeof(uint64_t));
+        wide = _mm_crc32_u64(wide, word);
+    }
+    crc = static_cast<uint32_t>(wide);
+#endif
+    for (; length >= 4; bytes += 4, length -= 4) {
+        uint32_t word;
+        std::memcpy(&word, bytes, sizeof(uint32_t));
+        crc = _mm_crc32_u32(crc, word);
+    }
+    for (; length > 0; ++bytes, --length) {
+        crc = _mm_crc32_u8(crc, *bytes);
+    }
+    return crc;
+}
+#endif
\ No newline at end of file
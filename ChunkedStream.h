@@ -0,0 +1,326 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../helpers/FileUtils.h"
+#include "../helpers/StringL.h"
+
+#include "CodecSettings.h"
+#include "SPSCQueue.h"
+#include "StreamUtils.h"
+
+template <typename charType, template <typename> class codecType>
+class ChunkedStream
+{
+public:
+    static void Encode(const std::function<size_t(charType*, size_t)>& source, std::ofstream& outputFile, const bool useUTF8);
+    static void Encode(std::istream& input, std::ofstream& outputFile, const bool useUTF8);
+    static void Decode(std::ifstream& inputFile, const bool useUTF8, const std::function<void(const charType*, size_t)>& sink);
+    static void Decode(std::ifstream& inputFile, const bool useUTF8, std::ostream& output);
+private:
+    ChunkedStream() = default;
+
+    using codec = codecType<charType>;
+
+    template <typename stagedType, typename = void>
+    struct is_staged : std::false_type {};
+    template <typename stagedType>
+    struct is_staged<stagedType, std::void_t<decltype(stagedType::stagesCount)>> : std::bool_constant<(stagedType::stagesCount > 1)> {};
+
+    const static size_t queueDepth = 2;
+
+    struct job {
+        typename codec::chunk chunk;
+        uint32_t count;
+    };
+
+    using queue = SPSCQueue<std::unique_ptr<job>>;
+
+    struct pipeline_state {
+        std::atomic<bool> cancelled{false};
+        std::exception_ptr error;
+        std::mutex mutex;
+
+        void fail();
+    };
+
+    template <typename writerType>
+    static void writeFrame(std::ofstream& outputFile, const uint32_t count, const writerType& writePayload);
+    static StringL<charType> readFrame(std::ifstream& inputFile, const uint32_t count, const bool useUTF8);
+
+    static void encodePipelined(const std::function<size_t(charType*, size_t)>& source, std::ofstream& outputFile, const bool useUTF8);
+    static void decodePipelined(std::ifstream& inputFile, const bool useUTF8, const std::function<void(const charType*, size_t)>& sink);
+
+    static void readJobs(const std::function<size_t(charType*, size_t)>& source, queue& output, pipeline_state& state);
+    static void readFrames(std::ifstream& inputFile, const bool useUTF8, queue& output, pipeline_state& state);
+    static void runStage(void (*process)(job&), queue& input, queue& output, pipeline_state& state);
+    static void finish(std::vector<std::thread>& threads, pipeline_state& state);
+
+    template <size_t index>
+    static void encodeStage(job& job) { codec::template EncodeStage<index>(job.chunk.buffer, job.chunk); }
+    template <size_t index>
+    static void decodeStage(job& job) { codec::template DecodeStage<index>(job.chunk); }
+
+    template <size_t... indices>
+    static void startEncodeStages(std::vector<std::thread>& threads, std::deque<queue>& queues, pipeline_state& state, std::index_sequence<indices...>);
+    template <size_t... indices>
+    static void startDecodeStages(std::vector<std::thread>& threads, std::deque<queue>& queues, pipeline_state& state, std::index_sequence<indices...>);
+};
+
+template <typename charType, template <typename> class codecType>
+void ChunkedStream<charType, codecType>::Encode(const std::function<size_t(charType*, size_t)>& source, std::ofstream& outputFile, const bool useUTF8)
+{
+    if constexpr (is_staged<codec>::value) {
+        if (CodecSettings::GetThreadsCount() > 1) {
+            encodePipelined(source, outputFile, useUTF8);
+            return;
+        }
+    }
+
+    std::vector<charType> buffer(CodecSettings::GetStreamChunkSize());
+    size_t count;
+    do {
+        count = StreamUtils::ReadChunk(source, buffer);
+        if (count < 1) break;
+
+        StringL<charType> chunk(count);
+        for (size_t i = 0; i < count; ++i) {
+            chunk.push_back(buffer[i]);
+        }
+        writeFrame(outputFile, static_cast<uint32_t>(count), [&]() { codec::Encode(chunk, outputFile, useUTF8); });
+    } while (count == buffer.size());
+
+    FileUtils::AppendValueBinary(outputFile, uint32_t(0));
+}
+
+template <typename charType, template <typename> class codecType>
+void ChunkedStream<charType, codecType>::Encode(std::istream& input, std::ofstream& outputFile, const bool useUTF8)
+{
+    Encode(StreamUtils::SourceFrom<charType>(input), outputFile, useUTF8);
+}
+
+template <typename charType, template <typename> class codecType>
+void ChunkedStream<charType, codecType>::Decode(std::ifstream& inputFile, const bool useUTF8, const std::function<void(const charType*, size_t)>& sink)
+{
+    if constexpr (is_staged<codec>::value) {
+        if (CodecSettings::GetThreadsCount() > 1) {
+            decodePipelined(inputFile, useUTF8, sink);
+            return;
+        }
+    }
+
+    uint32_t count;
+    while ((count = FileUtils::ReadValueBinary<uint32_t>(inputFile)) > 0) {
+        StringL<charType> chunk = readFrame(inputFile, count, useUTF8);
+        sink(&*chunk.begin(), chunk.size());
+    }
+}
+
+template <typename charType, template <typename> class codecType>
+void ChunkedStream<charType, codecType>::Decode(std::ifstream& inputFile, const bool useUTF8, std::ostream& output)
+{
+    Decode(inputFile, useUTF8, [&output](const charType* symbols, const size_t count) {
+        output.write(reinterpret_cast<const char*>(symbols), count * sizeof(charType));
+    });
+}
+
+template <typename charType, template <typename> class codecType>
+template <typename writerType>
+void ChunkedStream<charType, codecType>::writeFrame(std::ofstream& outputFile, const uint32_t count, const writerType& writePayload)
+{
+    const std::streampos frameStart = outputFile.tellp();
+    FileUtils::AppendValueBinary(outputFile, count);
+    FileUtils::AppendValueBinary(outputFile, uint32_t(0));
+    writePayload();
+
+    const std::streampos frameEnd = outputFile.tellp();
+    outputFile.seekp(frameStart + std::streamoff(sizeof(uint32_t)));
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint32_t>(frameEnd - frameStart - std::streamoff(2 * sizeof(uint32_t))));
+    outputFile.seekp(frameEnd);
+}
+
+template <typename charType, template <typename> class codecType>
+StringL<charType> ChunkedStream<charType, codecType>::readFrame(std::ifstream& inputFile, const uint32_t count, const bool useUTF8)
+{
+    const uint32_t payloadLength = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    const std::streampos payloadStart = inputFile.tellg();
+
+    StringL<charType> chunk = codec::Decode(inputFile, useUTF8);
+    if (chunk.size() != count) {
+        throw std::runtime_error("ChunkedStream error: chunk length does not match its frame");
+    }
+    if (inputFile.tellg() - payloadStart > std::streamoff(payloadLength)) {
+        throw std::runtime_error("ChunkedStream error: chunk exceeds its frame");
+    }
+    inputFile.seekg(payloadStart + std::streamoff(payloadLength));
+    return chunk;
+}
+
+template <typename charType, template <typename> class codecType>
+void ChunkedStream<charType, codecType>::encodePipelined(const std::function<size_t(charType*, size_t)>& source, std::ofstream& outputFile, const bool useUTF8)
+{
+    pipeline_state state;
+    std::deque<queue> queues;
+    for (size_t i = 0; i < codec::stagesCount; ++i) {
+        queues.emplace_back(size_t(queueDepth));
+    }
+
+    std::vector<std::thread> threads;
+    threads.emplace_back(&readJobs, std::cref(source), std::ref(queues.front()), std::ref(state));
+    startEncodeStages(threads, queues, state, std::make_index_sequence<codec::stagesCount - 1>());
+
+    try {
+        std::unique_ptr<job> job;
+        while (queues.back().Pop(job, state.cancelled) && job) {
+            writeFrame(outputFile, job->count, [&]() { codec::WriteChunk(job->chunk.buffer, job->chunk, outputFile, useUTF8); });
+        }
+    } catch (...) {
+        state.fail();
+    }
+    finish(threads, state);
+
+    FileUtils::AppendValueBinary(outputFile, uint32_t(0));
+}
+
+template <typename charType, template <typename> class codecType>
+void ChunkedStream<charType, codecType>::decodePipelined(std::ifstream& inputFile, const bool useUTF8, const std::function<void(const charType*, size_t)>& sink)
+{
+    pipeline_state state;
+    std::deque<queue> queues;
+    for (size_t i = 0; i < codec::stagesCount; ++i) {
+        queues.emplace_back(size_t(queueDepth));
+    }
+
+    std::vector<std::thread> threads;
+    threads.emplace_back(&readFrames, std::ref(inputFile), useUTF8, std::ref(queues.front()), std::ref(state));
+    startDecodeStages(threads, queues, state, std::make_index_sequence<codec::stagesCount - 1>());
+
+    try {
+        std::unique_ptr<job> job;
+        while (queues.back().Pop(job, state.cancelled) && job) {
+            if (job->chunk.buffer.size() != job->count) {
+                throw std::runtime_error("ChunkedStream error: chunk length does not match its frame");
+            }
+            sink(&*job->chunk.buffer.begin(), job->chunk.buffer.size());
+        }
+    } catch (...) {
+        state.fail();
+    }
+    finish(threads, state);
+}
+
+template <typename charType, template <typename> class codecType>
+void ChunkedStream<charType, codecType>::readJobs(const std::function<size_t(charType*, size_t)>& source, queue& output, pipeline_state& state)
+{
+    try {
+        std::vector<charType> buffer(CodecSettings::GetStreamChunkSize());
+        size_t count;
+        do {
+            count = StreamUtils::ReadChunk(source, buffer);
+            if (count < 1) break;
+
+            auto next = std::make_unique<job>();
+            next->count = static_cast<uint32_t>(count);
+            next->chunk.buffer = StringL<charType>(count);
+            for (size_t i = 0; i < count; ++i) {
+                next->chunk.buffer.push_back(buffer[i]);
+            }
+            if (!output.Push(std::move(next), state.cancelled)) return;
+        } while (count == buffer.size());
+
+        output.Push(std::unique_ptr<job>(), state.cancelled);
+    } catch (...) {
+        state.fail();
+    }
+}
+
+template <typename charType, template <typename> class codecType>
+void ChunkedStream<charType, codecType>::readFrames(std::ifstream& inputFile, const bool useUTF8, queue& output, pipeline_state& state)
+{
+    try {
+        uint32_t count;
+        while ((count = FileUtils::ReadValueBinary<uint32_t>(inputFile)) > 0) {
+            const uint32_t payloadLength = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+            const std::streampos payloadStart = inputFile.tellg();
+
+            auto next = std::make_unique<job>();
+            next->count = count;
+            codec::ReadChunk(inputFile, next->chunk, useUTF8);
+            if (inputFile.tellg() - payloadStart > std::streamoff(payloadLength)) {
+                throw std::runtime_error("ChunkedStream error: chunk exceeds its frame");
+            }
+            inputFile.seekg(payloadStart + std::streamoff(payloadLength));
+
+            if (!output.Push(std::move(next), state.cancelled)) return;
+        }
+
+        output.Push(std::unique_ptr<job>(), state.cancelled);
+    } catch (...) {
+        state.fail();
+    }
+}
+
+template <typename charType, template <typename> class codecType>
+void ChunkedStream<charType, codecType>::runStage(void (*process)(job&), queue& input, queue& output, pipeline_state& state)
+{
+    try {
+        std::unique_ptr<job> current;
+        while (input.Pop(current, state.cancelled)) {
+            const bool last = !current;
+            if (!last) {
+                process(*current);
+            }
+            if (!output.Push(std::move(current), state.cancelled) || last) return;
+        }
+    } catch (...) {
+        state.fail();
+    }
+}
+
+template <typename charType, template <typename> class codecType>
+void ChunkedStream<charType, codecType>::finish(std::vector<std::thread>& threads, pipeline_state& state)
+{
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    if (state.error) {
+        std::rethrow_exception(state.error);
+    }
+}
+
+template <typename charType, template <typename> class codecType>
+template <size_t... indices>
+void ChunkedStream<charType, codecType>::startEncodeStages(std::vector<std::thread>& threads, std::deque<queue>& queues, pipeline_state& state, std::index_sequence<indices...>)
+{
+    (threads.emplace_back(&runStage, &encodeStage<indices>, std::ref(queues[indices]), std::ref(queues[indices + 1]), std::ref(state)), ...);
+}
+
+template <typename charType, template <typename> class codecType>
+template <size_t... indices>
+void ChunkedStream<charType, codecType>::startDecodeStages(std::vector<std::thread>& threads, std::deque<queue>& queues, pipeline_state& state, std::index_sequence<indices...>)
+{
+    (threads.emplace_back(&runStage, &decodeStage<codec::stagesCount - 2 - indices>, std::ref(queues[indices]), std::ref(queues[indices + 1]), std::ref(state)), ...);
+}
+
+template <typename charType, template <typename> class codecType>
+void ChunkedStream<charType, codecType>::pipeline_state::fail()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!error) {
+        error = std::current_exception();
+    }
+    cancelled.store(true);
+}
\ No newline at end of file
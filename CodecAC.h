@@ -2,44 +2,134 @@
 
 #include <cstdint>
 #include <map>
-#include <cmath>
+#include <algorithm>
+#include <type_traits>
+#include <vector>
 
 #include "../helpers/FileUtils.h"
 #include "../helpers/CodecUTF8.h"
-#include "../helpers/TextUtils.h"
-#include "../helpers/BinaryUtils.h"
 #include "../helpers/BitArray.h"
 #include "../helpers/StringL.h"
 #include "../helpers/Array.h"
 
+#include "HistogramUtils.h"
+#include "BitStream.h"
+#include "RangeCoder.h"
+#include "AdaptiveFrequencyModel.h"
+#include "CodecSettings.h"
+#include "ThreadPool.h"
+
 template <typename charType>
 class CodecAC
 {
 public:
     static void Encode(StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8);
     static StringL<charType> Decode(std::ifstream& inputFile, const bool useUTF8);
+
+    class AdaptiveEncoder
+    {
+    public:
+        explicit AdaptiveEncoder(std::ofstream& outputFile);
+
+        void Put(const charType c);
+        void Finish();
+    private:
+        friend class CodecAC<charType>;
+
+        std::ofstream* outputFile;
+        Array<uint8_t> encodedBytes;
+        RangeEncoder encoder;
+        AdaptiveFrequencyModel model;
+        std::map<charType, uint32_t> symbolIndices;
+
+        AdaptiveEncoder();
+        void encodeSymbol(const uint32_t symbol);
+        void flush();
+    };
+
+    class AdaptiveDecoder
+    {
+    public:
+        explicit AdaptiveDecoder(std::ifstream& inputFile);
+
+        bool Get(charType& c);
+    private:
+        friend class CodecAC<charType>;
+
+        RangeDecoder decoder;
+        AdaptiveFrequencyModel model;
+        Array<charType> symbols;
+
+        explicit AdaptiveDecoder(const RangeDecoder& decoder);
+        uint32_t decodeSymbol();
+    };
 private:
     CodecAC() = default;
 
-    static inline void backSortInParallel(Array<charType>& alphabet, Array<double>& frequencies);
-    static Array<double> calculateSegments(const Array<charType>& alphabet, const Array<double>& frequencies);
-    static inline void binSearchStep(const Array<double>& segments, const double value, const char directionBit, int& start, int& end);
-    static inline bool foundLetter(const Array<double>& segments, const size_t index, const double low, const double high);
-    static void encodeFrequencies(std::ofstream& outputFile, const uint32_t strLength, const Array<double>& frequencies);
-    static Array<double> decodeFrequencies(std::ifstream& inputFile, const uint32_t strLength, const uint32_t alphabetLength);
+    enum Mode : uint8_t { Static = 0, Adaptive = 1, Blocked = 2 };
+
+    const static uint32_t endOfStreamSymbol = 0;
+    const static uint32_t escapeSymbol = 1;
+    const static uint32_t adaptiveIncrement = 32;
+    const static uint32_t adaptiveMaxTotalFrequency = 1 << 16;
+    const static size_t adaptiveFlushSize = 1 << 16;
+
+    const static uint32_t maxTotalBits = 16;
+    const static uint32_t maxAlphabetTotalBits = 24;
+    const static uint32_t maxLookupTotalBits = 16;
+
+    struct frequency_table {
+        uint32_t totalBits;
+        Array<uint32_t> frequencies;
+        Array<uint32_t> cumulativeFrequencies;
+        Array<uint32_t> lookup;
+    };
+
+    static Array<uint32_t> calculateFrequencies(const StringL<charType>& inputStr, Array<charType>& alphabet);
+    static inline void backSortInParallel(Array<charType>& alphabet, Array<uint32_t>& frequencies);
+    static uint32_t chooseTotalBits(const uint32_t strLength, const uint32_t alphabetLength);
+    static frequency_table buildFrequencyTable(const Array<uint32_t>& frequencies, const uint32_t totalBits);
+    static inline uint32_t findSymbol(const frequency_table& table, const uint32_t target);
+    static void encodeFrequencies(std::ofstream& outputFile, const uint32_t totalBits, const Array<uint32_t>& frequencies);
+    static Array<uint32_t> decodeFrequencies(std::ifstream& inputFile, const uint32_t alphabetLength, uint8_t& totalBits);
+    static std::ifstream& readAdaptiveMode(std::ifstream& inputFile);
+    static inline uint64_t symbolToKey(const charType c);
 protected:
-    struct data {
-        uint32_t inputStrLength;
+    struct data_local {
+        uint32_t blockLength;
         uint32_t alphabetLength;
         Array<charType> alphabet;
-        Array<double> frequencies;
-        BitArray resultValue;
-        data(const uint32_t& _inputStrLength, const uint32_t& _alphabetLength, const Array<charType>& _alphabet, const Array<double>& _frequencies, const BitArray& _resultValue) : 
-            inputStrLength(_inputStrLength), alphabetLength(_alphabetLength), alphabet(_alphabet), frequencies(_frequencies), resultValue(_resultValue) {}
+        uint8_t totalBits;
+        Array<uint32_t> frequencies;
+        Array<uint8_t> encodedBytes;
+        data_local(const uint32_t& _blockLength, const uint32_t& _alphabetLength, const Array<charType>& _alphabet,
+            const uint8_t _totalBits, const Array<uint32_t>& _frequencies, const Array<uint8_t>& _encodedBytes) :
+            blockLength(_blockLength), alphabetLength(_alphabetLength), alphabet(_alphabet),
+            totalBits(_totalBits), frequencies(_frequencies), encodedBytes(_encodedBytes) {}
+        data_local() = default;
+    };
+
+    struct data {
+        uint8_t mode;
+        uint32_t inputStrLength;
+        uint32_t blockSize;
+        Array<data_local> localDataItems;
+        Array<uint8_t> encodedBytes;
+        data(const uint8_t _mode, const uint32_t& _inputStrLength, const uint32_t& _blockSize, const Array<data_local>& _localDataItems) :
+            mode(_mode), inputStrLength(_inputStrLength), blockSize(_blockSize), localDataItems(_localDataItems) {}
+        data(const uint32_t& _inputStrLength, const Array<uint8_t>& _encodedBytes) :
+            mode(Mode::Adaptive), inputStrLength(_inputStrLength), blockSize(0), encodedBytes(_encodedBytes) {}
         data() = default;
     };
 
+    static data_local encodeBlock(const StringL<charType>& inputStr, const size_t begin, const size_t end);
+    static void writeBlock(std::ofstream& outputFile, const data_local& block, const bool useUTF8);
+    static data_local readBlock(std::ifstream& inputFile, const uint32_t blockLength, const bool useUTF8);
+    static StringL<charType> decodeBlock(const data_local& block);
+
     static data encodeToData(const StringL<charType>& inputStr);
+    static data encodeToDataAdaptive(const StringL<charType>& inputStr);
+    static data encodeToDataBlocked(const StringL<charType>& inputStr, const uint32_t blockSize);
     static void encodeData(std::ofstream& outputFile, const data& data, const bool useUTF8);
     static StringL<charType> decodeData(const data& data);
 };
@@ -47,145 +137,69 @@ protected:
 template <typename charType>
 void CodecAC<charType>::Encode(StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8)
 {
-    if (inputStr.size() < 1) {
-        FileUtils::AppendValueBinary(outputFile, static_cast<uint32_t>(0));
-        FileUtils::AppendValueBinary(outputFile, static_cast<uint32_t>(0));
-    }
-
-    double low, high, mid;
-    double low_temp, high_temp, mid_temp;
-    BitArray encodedBits;
-
-    Array<charType> alphabet = TextUtils::GetAlphabet(inputStr);
-    Array<double> frequencies = TextUtils::GetFrequencies(inputStr, alphabet);
-    backSortInParallel(alphabet, frequencies);
-    Array<double> segments = calculateSegments(alphabet, frequencies);
-
-    int k = 1, temp = alphabet.size();
-    while (temp > 1) { temp /= 2; ++k; }
-    encodedBits.resize(inputStr.size() * k);
-
-    size_t index;
-
-    for (const charType& c : inputStr)
-	{
-        for (index = 0; index < alphabet.size(); ++index) {
-            if (c == alphabet[index]) break;
-        }
-
-        high_temp = 1.0;
-        low_temp = 0.0;
-        mid_temp = (high_temp + low_temp) / 2.0;
-
-        low = segments[index];
-		high = segments[index + 1];
-        mid = (low + high) / 2.0;
-
-		while (!((high_temp <= high) && (low_temp >= low)))
-		{
-			if (mid_temp > mid) {
-                encodedBits.push_back('0');
-                high_temp = mid_temp;
-			} else {
-                encodedBits.push_back('1');
-				low_temp = mid_temp;
-			}
-
-            mid_temp = (high_temp + low_temp) / 2.0;
-		}
-	}
-
-    FileUtils::AppendValueBinary(outputFile, static_cast<uint32_t>(inputStr.size()));
-    FileUtils::AppendValueBinary(outputFile, static_cast<uint32_t>(alphabet.size()));
-    if (useUTF8) {
-        for (const charType& c : alphabet)
-            CodecUTF8::EncodeCharToBinaryFile(outputFile, c);
-    } else {
-        for (const charType& c : alphabet)
-            FileUtils::AppendValueBinary(outputFile, c);
-    }
-    encodeFrequencies(outputFile, inputStr.size(), frequencies);
-    BitArray::to_file(outputFile, encodedBits);
+    encodeData(outputFile, encodeToData(inputStr), useUTF8);
 }
 
 template <typename charType>
 StringL<charType> CodecAC<charType>::Decode(std::ifstream& inputFile, const bool useUTF8)
 {
-    uint32_t inputStrLength = FileUtils::ReadValueBinary<uint32_t>(inputFile);
-    if (inputStrLength < 1) { return StringL<charType>(); }
-
-    uint32_t alphabetLength = FileUtils::ReadValueBinary<uint32_t>(inputFile);
-    Array<charType> alphabet(alphabetLength);
-    if (useUTF8) {
-        for (uint32_t i = 0; i < alphabetLength; ++i) {
-            alphabet.push_back(CodecUTF8::DecodeCharFromBinaryFile<charType>(inputFile));
-        }
-    } else {
-        for (uint32_t i = 0; i < alphabetLength; ++i) {
-            alphabet.push_back(FileUtils::ReadValueBinary<charType>(inputFile));
+    data data;
+    data.mode = FileUtils::ReadValueBinary<uint8_t>(inputFile);
+    if (data.mode == Mode::Adaptive) {
+        StringL<charType> decodedStr;
+        AdaptiveDecoder decoder{RangeDecoder(inputFile)};
+        charType c;
+        while (decoder.Get(c)) {
+            decodedStr.push_back(c);
         }
+        return decodedStr;
+    } else if ((data.mode != Mode::Static) && (data.mode != Mode::Blocked)) {
+        throw std::runtime_error("CodecAC error: unknown mode");
     }
-    Array<double> frequencies = decodeFrequencies(inputFile, inputStrLength, alphabet.size());
-    Array<double> segments = calculateSegments(alphabet, frequencies);
-
-    double low, high, mid;
-    int segments_lowInd, segments_highInd;
-    size_t i = 0;
-    StringL<char> encodedBitsBlock = BinaryUtils::GetBinaryStringFromNumber<uint8_t>(
-        FileUtils::ReadValueBinary<uint8_t>(inputFile), 8);
-
-    StringL<charType> decodedStr(inputStrLength);
-
-    while (decodedStr.size() < inputStrLength) {
-        low = 0.0; high = 1.0;
-        mid = (high + low) / 2.0;
 
-        segments_lowInd = 0;
-        segments_highInd = segments.size() - 1;
+    data.inputStrLength = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    if (data.inputStrLength < 1) { return StringL<charType>(); }
 
-        while (true)
-        {
-            if (i == 8) {
-                encodedBitsBlock = BinaryUtils::GetBinaryStringFromNumber<uint8_t>(
-                    FileUtils::ReadValueBinary<uint8_t>(inputFile), 8);
-                i = 0;
-            }
-
-            if (encodedBitsBlock[i] == '0') {
-                high = mid;
-            } else {
-                low = mid;
-            }
+    if (data.mode == Mode::Static) {
+        data.blockSize = data.inputStrLength;
+        data.localDataItems.push_back(readBlock(inputFile, data.inputStrLength, useUTF8));
+        return decodeData(data);
+    }
 
-            binSearchStep(segments, mid, encodedBitsBlock[i], segments_lowInd, segments_highInd);
-            
-            mid = (high + low) / 2.0;
-            ++i;
+    data.blockSize = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    const uint32_t blocksCount = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    if ((data.blockSize < 1) || (blocksCount != (uint64_t(data.inputStrLength) + data.blockSize - 1) / data.blockSize)) {
+        throw std::runtime_error("CodecAC error: invalid block count");
+    }
 
-            if (segments_lowInd >= segments_highInd - 1) {
-                if (foundLetter(segments, segments_lowInd, low, high)) {
-                    break;
-                }
-            }
-        }
+    data.localDataItems.resize(blocksCount);
+    for (uint32_t i = 0; i < blocksCount; ++i) {
+        const uint32_t blockLength = std::min(data.blockSize, data.inputStrLength - i * data.blockSize);
+        data.localDataItems.push_back(readBlock(inputFile, blockLength, useUTF8));
+    }
 
+    return decodeData(data);
+}
 
-        decodedStr.push_back(alphabet[segments_lowInd]);
-    }
-    
-    return decodedStr;
+template <typename charType>
+Array<uint32_t> CodecAC<charType>::calculateFrequencies(const StringL<charType>& inputStr, Array<charType>& alphabet)
+{
+    Array<uint32_t> frequencies;
+    HistogramUtils::Build(inputStr, alphabet, frequencies);
+    return frequencies;
 }
+
 template <typename charType>
-void CodecAC<charType>::backSortInParallel(Array<charType>& alphabet, Array<double>& frequencies)
+void CodecAC<charType>::backSortInParallel(Array<charType>& alphabet, Array<uint32_t>& frequencies)
 {
-    Array<std::pair<charType, double>> charFrequencyVector;
+    Array<std::pair<charType, uint32_t>> charFrequencyVector;
     for (size_t i = 0; i < alphabet.size(); ++i) {
         charFrequencyVector.push_back({ alphabet[i], frequencies[i] });
     }
-    std::sort(charFrequencyVector.begin(), charFrequencyVector.end(), 
-        [](const std::pair<charType, double>& a, const std::pair<charType, double>& b)
+    std::stable_sort(charFrequencyVector.begin(), charFrequencyVector.end(),
+        [](const std::pair<charType, uint32_t>& a, const std::pair<charType, uint32_t>& b)
         { return a.second > b.second; });
-    
+
     alphabet.clear(); frequencies.clear();
     for (const auto& pair : charFrequencyVector) {
         alphabet.push_back(pair.first);
@@ -194,229 +208,382 @@ void CodecAC<charType>::backSortInParallel(Array<charType>& alphabet, Array<doub
 }
 
 template <typename charType>
-Array<double> CodecAC<charType>::calculateSegments(const Array<charType>& alphabet, const Array<double>& frequencies)
+uint32_t CodecAC<charType>::chooseTotalBits(const uint32_t strLength, const uint32_t alphabetLength)
 {
-    Array<double> segments;
-    if (alphabet.size() < 2) {
-        segments = { 0.0, 0.5, 1.0 };
-    } else {
-        segments.resize(alphabet.size() + 1);
-        segments.push_back(0.0);
-        for (size_t i = 1; i < alphabet.size(); ++i) {            
-            segments.push_back(frequencies[i - 1] + segments[i - 1]);
-        }
-        segments.push_back(1.0);
-    }
+    uint32_t totalBits = 1;
+    while ((totalBits < maxTotalBits) && ((uint64_t(1) << totalBits) < strLength)) ++totalBits;
+    while ((uint64_t(1) << totalBits) < alphabetLength) ++totalBits;
 
-    return segments;
+    if (totalBits > maxAlphabetTotalBits) {
+        throw std::runtime_error("CodecAC error: alphabet is too large");
+    }
+    return totalBits;
 }
 
 template <typename charType>
-void CodecAC<charType>::binSearchStep(const Array<double>& segments, const double value, const char directionBit, int& start, int& end)
+typename CodecAC<charType>::frequency_table CodecAC<charType>::buildFrequencyTable(const Array<uint32_t>& frequencies, const uint32_t totalBits)
 {
-    if (!((segments[start] <= value) && (value <= segments[end]))) {
-        throw std::runtime_error("CodecAC error: value is not in [segments[start], segments[end]]");
-    }
-
-    int left = start, right = end;
-    int center = (left + right) / 2;
-    
-    while (true) {
-        if (value >= segments[center])
-            left = center;
-        else
-            right = center;
-        
-        center = (left + right) / 2;
-        if (left >= right - 1){
-            if (directionBit == '0') {
-                end = right;
-            } else {
-                start = left;
+    frequency_table table;
+    table.totalBits = totalBits;
+    table.frequencies = frequencies;
+
+    table.cumulativeFrequencies.resize(frequencies.size() + 1);
+    uint64_t cumulativeFrequency = 0;
+    table.cumulativeFrequencies.push_back(0);
+    for (const uint32_t& frequency : frequencies) {
+        cumulativeFrequency += frequency;
+        table.cumulativeFrequencies.push_back(static_cast<uint32_t>(cumulativeFrequency));
+    }
+    if (cumulativeFrequency != (uint64_t(1) << totalBits)) {
+        throw std::runtime_error("CodecAC error: invalid frequency table");
+    }
+
+    if (totalBits <= maxLookupTotalBits) {
+        table.lookup.resize(cumulativeFrequency);
+        for (uint32_t symbol = 0; symbol < frequencies.size(); ++symbol) {
+            for (uint32_t _ = 0; _ < frequencies[symbol]; ++_) {
+                table.lookup.push_back(symbol);
             }
-            return;
         }
     }
+
+    return table;
 }
 
 template <typename charType>
-bool CodecAC<charType>::foundLetter(const Array<double>& segments, const size_t index, const double low, const double high)
+uint32_t CodecAC<charType>::findSymbol(const frequency_table& table, const uint32_t target)
 {
-    return (low >= segments[index]) && (high <= segments[index + 1]);
+    if (table.lookup.size() > 0) {
+        return table.lookup[target];
+    }
+    return static_cast<uint32_t>(std::upper_bound(table.cumulativeFrequencies.begin(), table.cumulativeFrequencies.end(), target)
+        - table.cumulativeFrequencies.begin()) - 1;
 }
 
 template <typename charType>
-void CodecAC<charType>::encodeFrequencies(std::ofstream& outputFile, const uint32_t strLength, const Array<double>& frequencies)
+void CodecAC<charType>::encodeFrequencies(std::ofstream& outputFile, const uint32_t totalBits, const Array<uint32_t>& frequencies)
 {
-    if (strLength < 1) {
-        return;
+    BitArray encoded;
+    for (const uint32_t& frequency : frequencies) {
+        BitStream::AppendGamma(encoded, frequency);
     }
 
-    Array<uint32_t> frequenciesInt(frequencies.size()); 
-    for (const double& freq : frequencies) {
-        frequenciesInt.push_back(std::round(freq * strLength));
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint8_t>(totalBits));
+    BitArray::to_file(outputFile, encoded);
+}
+
+template <typename charType>
+Array<uint32_t> CodecAC<charType>::decodeFrequencies(std::ifstream& inputFile, const uint32_t alphabetLength, uint8_t& totalBits)
+{
+    totalBits = FileUtils::ReadValueBinary<uint8_t>(inputFile);
+    if (totalBits > maxAlphabetTotalBits) {
+        throw std::runtime_error("CodecAC error: invalid frequency table");
     }
-    
-    uint32_t maxValue = frequenciesInt[0]; 
-    int maxBits = std::floor(std::log2(maxValue)) + 1; 
 
-    BitArray encoded(frequenciesInt.size() * maxBits);
-    for (const uint32_t& freqInt : frequenciesInt) {
-        for (const char& bit : BinaryUtils::GetBinaryStringFromNumber(freqInt, maxBits)) {
-            encoded.push_back(bit);
+    BitReader reader(inputFile);
+    Array<uint32_t> frequencies(alphabetLength);
+    while (frequencies.size() < alphabetLength) {
+        uint64_t frequency = reader.ReadGamma();
+        if (frequency > (uint64_t(1) << totalBits)) {
+            throw std::runtime_error("CodecAC error: invalid frequency table");
         }
+        frequencies.push_back(static_cast<uint32_t>(frequency));
     }
 
-    FileUtils::AppendValueBinary(outputFile, static_cast<uint8_t>(maxBits));
-    BitArray::to_file(outputFile, encoded);
+    return frequencies;
 }
 
 template <typename charType>
-Array<double> CodecAC<charType>::decodeFrequencies(std::ifstream& inputFile, const uint32_t strLength, const uint32_t alphabetLength)
+CodecAC<charType>::AdaptiveEncoder::AdaptiveEncoder(std::ofstream& outputFile) : AdaptiveEncoder()
+{
+    this->outputFile = &outputFile;
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint8_t>(Mode::Adaptive));
+}
+
+template <typename charType>
+CodecAC<charType>::AdaptiveEncoder::AdaptiveEncoder() : 
+    outputFile(nullptr), encoder(encodedBytes), model(escapeSymbol + 1, adaptiveIncrement, adaptiveMaxTotalFrequency) {}
+
+template <typename charType>
+void CodecAC<charType>::AdaptiveEncoder::Put(const charType c)
 {
-    if (strLength < 1) {
-        return Array<double>();
+    auto symbolIndex = symbolIndices.find(c);
+    if (symbolIndex != symbolIndices.end()) {
+        encodeSymbol(symbolIndex->second);
+    } else {
+        encodeSymbol(escapeSymbol);
+        const uint64_t key = symbolToKey(c);
+        for (int shift = 8 * (sizeof(charType) - 1); shift >= 0; shift -= 8) {
+            encoder.Encode(static_cast<uint32_t>((key >> shift) & 0xFF), 1, 256);
+        }
+        const uint32_t symbol = model.AddSymbol();
+        model.Update(symbol);
+        symbolIndices[c] = symbol;
     }
 
-    uint8_t maxBits = FileUtils::ReadValueBinary<uint8_t>(inputFile);
-    uint32_t encodedSize = (alphabetLength * maxBits);
-    while (encodedSize % 8 != 0) ++encodedSize; 
+    if (encodedBytes.size() >= adaptiveFlushSize) flush();
+}
 
-    BitArray encoded = BitArray::from_file(inputFile, encodedSize);
-    
+template <typename charType>
+void CodecAC<charType>::AdaptiveEncoder::Finish()
+{
+    encodeSymbol(endOfStreamSymbol);
+    encoder.Flush();
+    flush();
+}
 
-    Array<double> frequencies(alphabetLength);
-    size_t i = 0;
-    uint32_t value;
-    while (frequencies.size() < alphabetLength) {
-        value = 0;
-        for (uint8_t _ = 0; _ < maxBits; ++_) {
-            if (encoded.get_bit(i++) == '0') {
-                value <<= 1;
-            } else {
-                value <<= 1; value |= 1;
-            }
+template <typename charType>
+void CodecAC<charType>::AdaptiveEncoder::encodeSymbol(const uint32_t symbol)
+{
+    encoder.Encode(model.GetCumulativeFrequency(symbol), model.GetFrequency(symbol), model.GetTotalFrequency());
+    model.Update(symbol);
+}
+
+template <typename charType>
+void CodecAC<charType>::AdaptiveEncoder::flush()
+{
+    if (outputFile == nullptr) return;
+
+    outputFile->write(reinterpret_cast<const char*>(encodedBytes.begin()), encodedBytes.size());
+    encodedBytes.clear();
+}
+
+template <typename charType>
+CodecAC<charType>::AdaptiveDecoder::AdaptiveDecoder(std::ifstream& inputFile) : AdaptiveDecoder(RangeDecoder(readAdaptiveMode(inputFile))) {}
+
+template <typename charType>
+CodecAC<charType>::AdaptiveDecoder::AdaptiveDecoder(const RangeDecoder& decoder) : 
+    decoder(decoder), model(escapeSymbol + 1, adaptiveIncrement, adaptiveMaxTotalFrequency) {}
+
+template <typename charType>
+bool CodecAC<charType>::AdaptiveDecoder::Get(charType& c)
+{
+    const uint32_t symbol = decodeSymbol();
+    if (symbol == endOfStreamSymbol) return false;
+
+    if (symbol == escapeSymbol) {
+        uint64_t key = 0;
+        for (size_t i = 0; i < sizeof(charType); ++i) {
+            const uint32_t byte = decoder.GetFrequency(256);
+            decoder.Decode(byte, 1);
+            key = (key << 8) | byte;
         }
-        frequencies.push_back( value / static_cast<double>(strLength) );
+        c = static_cast<charType>(key);
+        symbols.push_back(c);
+        model.Update(model.AddSymbol());
+    } else {
+        c = symbols[symbol - escapeSymbol - 1];
     }
+    return true;
+}
 
-    return frequencies;
+template <typename charType>
+uint32_t CodecAC<charType>::AdaptiveDecoder::decodeSymbol()
+{
+    const uint32_t symbol = model.FindSymbol(decoder.GetFrequency(model.GetTotalFrequency()));
+    decoder.Decode(model.GetCumulativeFrequency(symbol), model.GetFrequency(symbol));
+    model.Update(symbol);
+    return symbol;
+}
+
+template <typename charType>
+std::ifstream& CodecAC<charType>::readAdaptiveMode(std::ifstream& inputFile)
+{
+    if (FileUtils::ReadValueBinary<uint8_t>(inputFile) != Mode::Adaptive) {
+        throw std::runtime_error("CodecAC error: stream is not adaptive");
+    }
+    return inputFile;
+}
+
+template <typename charType>
+uint64_t CodecAC<charType>::symbolToKey(const charType c)
+{
+    return static_cast<uint64_t>(static_cast<std::make_unsigned_t<charType>>(c));
 }
 
 template <typename charType>
 typename CodecAC<charType>::data CodecAC<charType>::encodeToData(const StringL<charType>& inputStr)
 {
-    if (inputStr.size() < 1) {
-        return data(0, 0, Array<charType>(), Array<double>(), BitArray());
+    const uint32_t blockSize = CodecSettings::GetACBlockSize();
+    if ((blockSize > 0) && (inputStr.size() > blockSize)) {
+        return encodeToDataBlocked(inputStr, blockSize);
     }
+    return encodeToDataAdaptive(inputStr);
+}
 
-    double low, high, mid;
-    double low_temp, high_temp, mid_temp;
-    BitArray encodedBits;
+template <typename charType>
+typename CodecAC<charType>::data CodecAC<charType>::encodeToDataAdaptive(const StringL<charType>& inputStr)
+{
+    AdaptiveEncoder encoder;
+    for (const charType& c : inputStr) {
+        encoder.Put(c);
+    }
+    encoder.Finish();
 
-    Array<charType> alphabet = TextUtils::GetAlphabet<charType>(inputStr);
-    Array<double> frequencies = TextUtils::GetFrequencies(inputStr, alphabet);
-    backSortInParallel(alphabet, frequencies);
-    Array<double> segments = calculateSegments(alphabet, frequencies);
+    return data(inputStr.size(), encoder.encodedBytes);
+}
 
-    int k = 1, temp = alphabet.size();
-    while (temp > 1) { temp /= 2; ++k; }
-    encodedBits.resize(inputStr.size() * k);
+template <typename charType>
+typename CodecAC<charType>::data CodecAC<charType>::encodeToDataBlocked(const StringL<charType>& inputStr, const uint32_t blockSize)
+{
+    const size_t blocksCount = (inputStr.size() + blockSize - 1) / blockSize;
+    std::vector<data_local> blocks(blocksCount);
+    ThreadPool::Shared()->ParallelFor(blocksCount, [&](const size_t i) {
+        const size_t begin = i * blockSize;
+        blocks[i] = encodeBlock(inputStr, begin, std::min(begin + blockSize, inputStr.size()));
+    });
+
+    Array<data_local> localDataItems(blocksCount);
+    for (data_local& block : blocks) {
+        localDataItems.push_back(block);
+        block = data_local();
+    }
+    return data(Mode::Blocked, inputStr.size(), blockSize, localDataItems);
+}
 
-    size_t index;
+template <typename charType>
+typename CodecAC<charType>::data_local CodecAC<charType>::encodeBlock(const StringL<charType>& inputStr, const size_t begin, const size_t end)
+{
+    Array<charType> alphabet;
+    Array<uint32_t> counts;
+    HistogramUtils::Build(inputStr, begin, end, alphabet, counts);
+    backSortInParallel(alphabet, counts);
+
+    const uint32_t totalBits = chooseTotalBits(end - begin, alphabet.size());
+    Array<uint32_t> frequencies = HistogramUtils::Normalize(counts, totalBits);
+    frequency_table table = buildFrequencyTable(frequencies, totalBits);
+
+    std::map<charType, uint32_t> symbolIndices;
+    for (uint32_t i = 0; i < alphabet.size(); ++i) {
+        symbolIndices[alphabet[i]] = i;
+    }
 
-    for (const charType& c : inputStr)
-	{
-        for (index = 0; index < alphabet.size(); ++index) {
-            if (c == alphabet[index]) break;
-        }
+    Array<uint8_t> encodedBytes((end - begin) / 2 + 16);
+    RangeEncoder encoder(encodedBytes);
+    for (size_t i = begin; i < end; ++i) {
+        const uint32_t index = symbolIndices[inputStr[i]];
+        encoder.Encode(table.cumulativeFrequencies[index], table.frequencies[index], uint32_t(1) << totalBits);
+    }
+    encoder.Flush();
 
-        high_temp = 1.0;
-        low_temp = 0.0;
-        mid_temp = (high_temp + low_temp) / 2.0;
-
-        low = segments[index];
-		high = segments[index + 1];
-        mid = (low + high) / 2.0;
-
-		while (!((high_temp <= high) && (low_temp >= low)))
-		{
-			if (mid_temp > mid) {
-                encodedBits.push_back('0');
-                high_temp = mid_temp;
-			} else {
-                encodedBits.push_back('1');
-				low_temp = mid_temp;
-			}
-
-            mid_temp = (high_temp + low_temp) / 2.0;
-		}
-	}
-
-    return data(inputStr.size(), alphabet.size(), alphabet, frequencies, encodedBits);
+    return data_local(end - begin, alphabet.size(), alphabet, totalBits, frequencies, encodedBytes);
 }
 
 template <typename charType>
-void CodecAC<charType>::encodeData(std::ofstream& outputFile, const data& data, const bool useUTF8)
+void CodecAC<charType>::writeBlock(std::ofstream& outputFile, const data_local& block, const bool useUTF8)
 {
-    FileUtils::AppendValueBinary(outputFile, data.inputStrLength);
-    FileUtils::AppendValueBinary(outputFile, data.alphabetLength);
+    FileUtils::AppendValueBinary(outputFile, block.alphabetLength);
     if (useUTF8) {
-        for (const charType& c : data.alphabet)
+        for (const charType& c : block.alphabet)
             CodecUTF8::EncodeCharToBinaryFile(outputFile, c);
     } else {
-        for (const charType& c : data.alphabet)
+        for (const charType& c : block.alphabet)
             FileUtils::AppendValueBinary(outputFile, c);
     }
-    encodeFrequencies(outputFile, data.inputStrLength, data.frequencies);
-    BitArray::to_file(outputFile, data.resultValue);
+    encodeFrequencies(outputFile, block.totalBits, block.frequencies);
+
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint32_t>(block.encodedBytes.size()));
+    outputFile.write(reinterpret_cast<const char*>(block.encodedBytes.begin()), block.encodedBytes.size());
 }
 
 template <typename charType>
-StringL<charType> CodecAC<charType>::decodeData(const data& data)
+typename CodecAC<charType>::data_local CodecAC<charType>::readBlock(std::ifstream& inputFile, const uint32_t blockLength, const bool useUTF8)
 {
-    if (data.inputStrLength < 1) {
-        return StringL<charType>();
+    data_local block;
+    block.blockLength = blockLength;
+    block.alphabetLength = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    block.alphabet.resize(block.alphabetLength);
+    if (useUTF8) {
+        for (uint32_t i = 0; i < block.alphabetLength; ++i) {
+            block.alphabet.push_back(CodecUTF8::DecodeCharFromBinaryFile<charType>(inputFile));
+        }
+    } else {
+        for (uint32_t i = 0; i < block.alphabetLength; ++i) {
+            block.alphabet.push_back(FileUtils::ReadValueBinary<charType>(inputFile));
+        }
     }
+    block.frequencies = decodeFrequencies(inputFile, block.alphabetLength, block.totalBits);
 
-    StringL<charType> decodedStr(data.inputStrLength);
-    
-    Array<double> segments = calculateSegments(data.alphabet, data.frequencies);
-    double low, high, mid;
-    int segments_lowInd, segments_highInd;
-    char bit;
-    size_t i = 0;
-
-    while (decodedStr.size() < data.inputStrLength) {
-        low = 0.0; high = 1.0;
-        mid = (high + low) / 2.0;
-
-        segments_lowInd = 0;
-        segments_highInd = segments.size() - 1;
-
-        while (true)
-        {
-            bit = data.resultValue.get_bit(i);
-            if (bit == '0') {
-                high = mid;
-            } else {
-                low = mid;
-            }
+    uint32_t encodedLength = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    block.encodedBytes.resize(encodedLength);
+    for (uint32_t i = 0; i < encodedLength; ++i) {
+        block.encodedBytes.push_back(FileUtils::ReadValueBinary<uint8_t>(inputFile));
+    }
 
-            binSearchStep(segments, mid, bit, segments_lowInd, segments_highInd);
-            
-            mid = (high + low) / 2.0;
-            ++i;
+    return block;
+}
 
-            if (segments_lowInd >= segments_highInd - 1) {
-                if (foundLetter(segments, segments_lowInd, low, high)) {
-                    break;
-                }
-            }
+template <typename charType>
+StringL<charType> CodecAC<charType>::decodeBlock(const data_local& block)
+{
+    StringL<charType> decodedStr(block.blockLength);
+
+    frequency_table table = buildFrequencyTable(block.frequencies, block.totalBits);
+    const uint32_t totalFrequency = uint32_t(1) << block.totalBits;
+
+    RangeDecoder decoder(block.encodedBytes.begin(), block.encodedBytes.end());
+    while (decodedStr.size() < block.blockLength) {
+        const uint32_t index = findSymbol(table, decoder.GetFrequency(totalFrequency));
+        decoder.Decode(table.cumulativeFrequencies[index], table.frequencies[index]);
+        decodedStr.push_back(block.alphabet[index]);
+    }
+
+    return decodedStr;
+}
+
+template <typename charType>
+void CodecAC<charType>::encodeData(std::ofstream& outputFile, const data& data, const bool useUTF8)
+{
+    FileUtils::AppendValueBinary(outputFile, data.mode);
+    if (data.mode == Mode::Adaptive) {
+        outputFile.write(reinterpret_cast<const char*>(data.encodedBytes.begin()), data.encodedBytes.size());
+        return;
+    }
+
+    FileUtils::AppendValueBinary(outputFile, data.inputStrLength);
+    if (data.inputStrLength < 1) return;
+
+    if (data.mode == Mode::Static) {
+        writeBlock(outputFile, data.localDataItems[0], useUTF8);
+        return;
+    }
+
+    FileUtils::AppendValueBinary(outputFile, data.blockSize);
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint32_t>(data.localDataItems.size()));
+    for (const data_local& block : data.localDataItems) {
+        writeBlock(outputFile, block, useUTF8);
+    }
+}
+
+template <typename charType>
+StringL<charType> CodecAC<charType>::decodeData(const data& data)
+{
+    if (data.mode == Mode::Adaptive) {
+        StringL<charType> decodedStr(data.inputStrLength);
+        AdaptiveDecoder decoder{RangeDecoder(data.encodedBytes.begin(), data.encodedBytes.end())};
+        charType c;
+        while (decoder.Get(c)) {
+            decodedStr.push_back(c);
         }
+        return decodedStr;
+    }
 
-        decodedStr.push_back(data.alphabet[segments_lowInd]);
+    if (data.inputStrLength < 1) {
+        return StringL<charType>();
+    }
+    if (data.localDataItems.size() == 1) {
+        return decodeBlock(data.localDataItems[0]);
     }
 
+    std::vector<StringL<charType>> decodedBlocks(data.localDataItems.size());
+    ThreadPool::Shared()->ParallelFor(decodedBlocks.size(), [&](const size_t i) {
+        decodedBlocks[i] = decodeBlock(data.localDataItems[i]);
+    });
+
+    StringL<charType> decodedStr(data.inputStrLength);
+    for (StringL<charType>& block : decodedBlocks) {
+        decodedStr.push_back(block);
+        block.free_memory();
+    }
     return decodedStr;
 }
\ No newline at end of file
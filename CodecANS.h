@@ -0,0 +1,275 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+#include "../helpers/FileUtils.h"
+#include "../helpers/CodecUTF8.h"
+#include "../helpers/BitArray.h"
+#include "../helpers/StringL.h"
+#include "../helpers/Array.h"
+
+#include "HistogramUtils.h"
+#include "BitStream.h"
+
+template <typename charType>
+class CodecANS
+{
+public:
+    static void Encode(StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8);
+    static StringL<charType> Decode(std::ifstream& inputFile, const bool useUTF8);
+private:
+    CodecANS() = default;
+
+    const static uint32_t stateLowerBound = 1 << 23;
+    const static uint32_t statesCount = 2;
+    const static uint32_t maxScaleBits = 14;
+    const static uint32_t maxAlphabetScaleBits = 20;
+
+    struct symbol_table {
+        uint32_t scaleBits;
+        Array<uint32_t> frequencies;
+        Array<uint32_t> cumulativeFrequencies;
+        Array<uint32_t> slots;
+    };
+
+    static uint32_t chooseScaleBits(const uint32_t strLength, const uint32_t alphabetLength);
+    static symbol_table buildSymbolTable(const Array<uint32_t>& frequencies, const uint32_t scaleBits);
+    static void encodeFrequencies(std::ofstream& outputFile, const uint32_t scaleBits, const Array<uint32_t>& frequencies);
+    static Array<uint32_t> decodeFrequencies(std::ifstream& inputFile, const uint32_t alphabetLength, uint8_t& scaleBits);
+protected:
+    struct data {
+        uint32_t inputStrLength;
+        uint32_t alphabetLength;
+        Array<charType> alphabet;
+        uint8_t scaleBits;
+        Array<uint32_t> frequencies;
+        Array<uint8_t> encodedBytes;
+        data(const uint32_t& _inputStrLength, const uint32_t& _alphabetLength, const Array<charType>& _alphabet,
+            const uint8_t _scaleBits, const Array<uint32_t>& _frequencies, const Array<uint8_t>& _encodedBytes) :
+            inputStrLength(_inputStrLength), alphabetLength(_alphabetLength), alphabet(_alphabet),
+            scaleBits(_scaleBits), frequencies(_frequencies), encodedBytes(_encodedBytes) {}
+        data() = default;
+    };
+
+    static data encodeToData(const StringL<charType>& inputStr);
+    static void encodeData(std::ofstream& outputFile, const data& data, const bool useUTF8);
+    static StringL<charType> decodeData(const data& data);
+};
+
+template <typename charType>
+void CodecANS<charType>::Encode(StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8)
+{
+    encodeData(outputFile, encodeToData(inputStr), useUTF8);
+}
+
+template <typename charType>
+StringL<charType> CodecANS<charType>::Decode(std::ifstream& inputFile, const bool useUTF8)
+{
+    data data;
+    data.inputStrLength = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    if (data.inputStrLength < 1) { return StringL<charType>(); }
+
+    data.alphabetLength = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    data.alphabet.resize(data.alphabetLength);
+    if (useUTF8) {
+        for (uint32_t i = 0; i < data.alphabetLength; ++i) {
+            data.alphabet.push_back(CodecUTF8::DecodeCharFromBinaryFile<charType>(inputFile));
+        }
+    } else {
+        for (uint32_t i = 0; i < data.alphabetLength; ++i) {
+            data.alphabet.push_back(FileUtils::ReadValueBinary<charType>(inputFile));
+        }
+    }
+    data.frequencies = decodeFrequencies(inputFile, data.alphabetLength, data.scaleBits);
+
+    uint32_t encodedLength = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    data.encodedBytes.resize(encodedLength);
+    for (uint32_t i = 0; i < encodedLength; ++i) {
+        data.encodedBytes.push_back(FileUtils::ReadValueBinary<uint8_t>(inputFile));
+    }
+
+    return decodeData(data);
+}
+
+template <typename charType>
+uint32_t CodecANS<charType>::chooseScaleBits(const uint32_t strLength, const uint32_t alphabetLength)
+{
+    uint32_t scaleBits = 1;
+    while ((scaleBits < maxScaleBits) && ((uint64_t(1) << scaleBits) < strLength)) ++scaleBits;
+    while ((uint64_t(1) << scaleBits) < alphabetLength) ++scaleBits;
+
+    if (scaleBits > maxAlphabetScaleBits) {
+        throw std::runtime_error("CodecANS error: alphabet is too large");
+    }
+    return scaleBits;
+}
+
+template <typename charType>
+typename CodecANS<charType>::symbol_table CodecANS<charType>::buildSymbolTable(const Array<uint32_t>& frequencies, const uint32_t scaleBits)
+{
+    symbol_table table;
+    table.scaleBits = scaleBits;
+    table.frequencies = frequencies;
+
+    table.cumulativeFrequencies.resize(frequencies.size() + 1);
+    uint64_t cumulativeFrequency = 0;
+    table.cumulativeFrequencies.push_back(0);
+    for (const uint32_t& frequency : frequencies) {
+        cumulativeFrequency += frequency;
+        table.cumulativeFrequencies.push_back(static_cast<uint32_t>(cumulativeFrequency));
+    }
+    if (cumulativeFrequency != (uint64_t(1) << scaleBits)) {
+        throw std::runtime_error("CodecANS error: invalid frequency table");
+    }
+
+    table.slots.resize(cumulativeFrequency);
+    for (uint32_t symbol = 0; symbol < frequencies.size(); ++symbol) {
+        for (uint32_t _ = 0; _ < frequencies[symbol]; ++_) {
+            table.slots.push_back(symbol);
+        }
+    }
+
+    return table;
+}
+
+template <typename charType>
+void CodecANS<charType>::encodeFrequencies(std::ofstream& outputFile, const uint32_t scaleBits, const Array<uint32_t>& frequencies)
+{
+    BitArray encoded;
+    for (const uint32_t& frequency : frequencies) {
+        BitStream::AppendGamma(encoded, frequency);
+    }
+
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint8_t>(scaleBits));
+    BitArray::to_file(outputFile, encoded);
+}
+
+template <typename charType>
+Array<uint32_t> CodecANS<charType>::decodeFrequencies(std::ifstream& inputFile, const uint32_t alphabetLength, uint8_t& scaleBits)
+{
+    scaleBits = FileUtils::ReadValueBinary<uint8_t>(inputFile);
+    if (scaleBits > maxAlphabetScaleBits) {
+        throw std::runtime_error("CodecANS error: invalid frequency table");
+    }
+
+    BitReader reader(inputFile);
+    Array<uint32_t> frequencies(alphabetLength);
+    while (frequencies.size() < alphabetLength) {
+        uint64_t frequency = reader.ReadGamma();
+        if (frequency > (uint64_t(1) << scaleBits)) {
+            throw std::runtime_error("CodecANS error: invalid frequency table");
+        }
+        frequencies.push_back(static_cast<uint32_t>(frequency));
+    }
+
+    return frequencies;
+}
+
+template <typename charType>
+typename CodecANS<charType>::data CodecANS<charType>::encodeToData(const StringL<charType>& inputStr)
+{
+    if (inputStr.size() < 1) {
+        return data(0, 0, Array<charType>(), 0, Array<uint32_t>(), Array<uint8_t>());
+    }
+
+    Array<charType> alphabet;
+    Array<uint32_t> counts;
+    HistogramUtils::Build(inputStr, alphabet, counts);
+
+    const uint32_t scaleBits = chooseScaleBits(inputStr.size(), alphabet.size());
+    Array<uint32_t> frequencies = HistogramUtils::Normalize(counts, scaleBits);
+    symbol_table table = buildSymbolTable(frequencies, scaleBits);
+
+    uint32_t states[statesCount];
+    std::fill(std::begin(states), std::end(states), stateLowerBound);
+
+    Array<uint8_t> encodedBytes(inputStr.size() / 2 + 16);
+    for (size_t i = inputStr.size(); i-- > 0;) {
+        uint32_t& state = states[i % statesCount];
+        const uint32_t index = static_cast<uint32_t>(std::lower_bound(alphabet.begin(), alphabet.end(), inputStr[i]) - alphabet.begin());
+        const uint32_t frequency = table.frequencies[index];
+
+        const uint32_t maxState = ((stateLowerBound >> scaleBits) << 8) * frequency;
+        while (state >= maxState) {
+            encodedBytes.push_back(static_cast<uint8_t>(state & 0xFF));
+            state >>= 8;
+        }
+        state = ((state / frequency) << scaleBits) + (state % frequency) + table.cumulativeFrequencies[index];
+    }
+    for (uint32_t s = statesCount; s-- > 0;) {
+        for (int _ = 0; _ < 4; ++_) {
+            encodedBytes.push_back(static_cast<uint8_t>(states[s] & 0xFF));
+            states[s] >>= 8;
+        }
+    }
+    std::reverse(encodedBytes.begin(), encodedBytes.end());
+
+    return data(inputStr.size(), alphabet.size(), alphabet, scaleBits, frequencies, encodedBytes);
+}
+
+template <typename charType>
+void CodecANS<charType>::encodeData(std::ofstream& outputFile, const data& data, const bool useUTF8)
+{
+    FileUtils::AppendValueBinary(outputFile, data.inputStrLength);
+    if (data.inputStrLength < 1) return;
+
+    FileUtils::AppendValueBinary(outputFile, data.alphabetLength);
+    if (useUTF8) {
+        for (const charType& c : data.alphabet)
+            CodecUTF8::EncodeCharToBinaryFile(outputFile, c);
+    } else {
+        for (const charType& c : data.alphabet)
+            FileUtils::AppendValueBinary(outputFile, c);
+    }
+    encodeFrequencies(outputFile, data.scaleBits, data.frequencies);
+
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint32_t>(data.encodedBytes.size()));
+    outputFile.write(reinterpret_cast<const char*>(data.encodedBytes.begin()), data.encodedBytes.size());
+}
+
+template <typename charType>
+StringL<charType> CodecANS<charType>::decodeData(const data& data)
+{
+    if (data.inputStrLength < 1) {
+        return StringL<charType>();
+    }
+
+    StringL<charType> decodedStr(data.inputStrLength);
+
+    symbol_table table = buildSymbolTable(data.frequencies, data.scaleBits);
+    const uint32_t mask = (uint32_t(1) << data.scaleBits) - 1;
+
+    const uint8_t* current = data.encodedBytes.begin();
+    const uint8_t* end = data.encodedBytes.end();
+    if (end - current < static_cast<ptrdiff_t>(4 * statesCount)) {
+        throw std::runtime_error("CodecANS error: encoded data is too short");
+    }
+
+    uint32_t states[statesCount];
+    for (uint32_t s = 0; s < statesCount; ++s) {
+        states[s] = 0;
+        for (int _ = 0; _ < 4; ++_) {
+            states[s] = (states[s] << 8) | *current++;
+        }
+    }
+
+    for (uint32_t i = 0; i < data.inputStrLength; ++i) {
+        uint32_t& state = states[i % statesCount];
+        const uint32_t slot = state & mask;
+        const uint32_t index = table.slots[slot];
+
+        state = table.frequencies[index] * (state >> data.scaleBits) + slot - table.cumulativeFrequencies[index];
+        while (state < stateLowerBound) {
+            if (current == end) {
+                throw std::runtime_error("CodecANS error: unexpected end of encoded data");
+            }
+            state = (state << 8) | *current++;
+        }
+
+        decodedStr.push_back(data.alphabet[index]);
+    }
+
+    return decodedStr;
+}
\ No newline at end of file
@@ -0,0 +1,286 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <type_traits>
+
+#include "../helpers/FileUtils.h"
+#include "../helpers/StringL.h"
+#include "../helpers/Array.h"
+
+#include "RangeCoder.h"
+#include "ContextMixing.h"
+#include "CodecSettings.h"
+
+template <typename charType>
+class CodecCM
+{
+public:
+    static void Encode(StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8);
+    static StringL<charType> Decode(std::ifstream& inputFile, const bool useUTF8);
+private:
+    CodecCM() = default;
+
+    typedef typename std::make_unsigned<charType>::type valueType;
+
+    const static uint32_t maxBucket = 8 * sizeof(charType);
+    const static uint32_t unaryNodesCount = maxBucket + 1;
+    const static uint32_t nodesCount = unaryNodesCount + ((maxBucket + 1) * maxBucket << 2);
+    const static uint32_t nodeClassesCount = unaryNodesCount + 1;
+    const static uint32_t symbolContextsCount = 32;
+    const static uint32_t maxZeroRunContext = 15;
+    const static uint32_t maxOrder2Bits = 22;
+
+    struct context_model {
+        CodecSettings::CMLevel level;
+        ProbabilityMap order0;
+        ProbabilityMap order1;
+        ProbabilityMap order2;
+        ProbabilityMap zeroRun;
+        Mixer mixer;
+        Mixer runMixer;
+        APM order1Apm;
+        APM order2Apm;
+        size_t order2Mask;
+        uint32_t context1;
+        uint32_t context2;
+        uint32_t zeroRunLength;
+        uint32_t node;
+        uint32_t probability;
+
+        explicit context_model(const CodecSettings::CMLevel level);
+
+        void SetNode(const uint32_t _node) { node = _node; }
+        uint32_t Predict();
+        void Update(const int bit);
+        void EndSymbol(const uint64_t value);
+    };
+
+    static uint32_t bucketOf(const uint64_t value);
+    static uint32_t symbolContext(const uint64_t value);
+    static size_t order2Size();
+
+    template <typename bitFunction>
+    static uint64_t codeValue(context_model& model, bitFunction&& codeBit, const uint64_t value);
+protected:
+    struct data {
+        uint32_t inputStrLength;
+        CodecSettings::CMLevel level;
+        Array<uint8_t> encodedBytes;
+        data(const uint32_t& _inputStrLength, const CodecSettings::CMLevel _level, const Array<uint8_t>& _encodedBytes) :
+            inputStrLength(_inputStrLength), level(_level), encodedBytes(_encodedBytes) {}
+        data() = default;
+    };
+
+    static data encodeToData(const StringL<charType>& inputStr);
+    static void encodeData(std::ofstream& outputFile, const data& data, const bool useUTF8);
+    static StringL<charType> decodeData(const data& data);
+};
+
+template <typename charType>
+void CodecCM<charType>::Encode(StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8)
+{
+    encodeData(outputFile, encodeToData(inputStr), useUTF8);
+}
+
+template <typename charType>
+StringL<charType> CodecCM<charType>::Decode(std::ifstream& inputFile, const bool useUTF8)
+{
+    data data;
+    data.inputStrLength = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    if (data.inputStrLength < 1) { return StringL<charType>(); }
+
+    const uint8_t level = FileUtils::ReadValueBinary<uint8_t>(inputFile);
+    if (level > CodecSettings::Max) {
+        throw std::runtime_error("CodecCM error: unknown level");
+    }
+    data.level = static_cast<CodecSettings::CMLevel>(level);
+
+    uint32_t encodedLength = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    data.encodedBytes.resize(encodedLength);
+    for (uint32_t i = 0; i < encodedLength; ++i) {
+        data.encodedBytes.push_back(FileUtils::ReadValueBinary<uint8_t>(inputFile));
+    }
+
+    return decodeData(data);
+}
+
+template <typename charType>
+CodecCM<charType>::context_model::context_model(const CodecSettings::CMLevel level) :
+    level(level),
+    order0(nodesCount, 1023),
+    order1(size_t(symbolContextsCount) * nodesCount, 255),
+    order2(order2Size(), 255),
+    zeroRun(size_t(maxZeroRunContext + 1) * nodesCount, 255),
+    mixer(5, symbolContextsCount * nodeClassesCount, 2),
+    runMixer(5, level == CodecSettings::Max ? (maxZeroRunContext + 1) * nodeClassesCount : 1, 2),
+    order1Apm(symbolContextsCount * nodeClassesCount, 7),
+    order2Apm(level == CodecSettings::Max ? symbolContextsCount * symbolContextsCount * nodeClassesCount : 1, 7),
+    order2Mask(order2Size() - 1), context1(0), context2(0), zeroRunLength(0), node(0), probability(2048) {}
+
+template <typename charType>
+uint32_t CodecCM<charType>::context_model::Predict()
+{
+    const uint32_t nodeClass = std::min(node, unaryNodesCount);
+    const uint32_t context12 = context2 * symbolContextsCount + context1;
+
+    const uint32_t runContext = std::min(zeroRunLength, maxZeroRunContext);
+    const int inputs[] = {
+        Logistic::Stretch(order0.Predict(node)),
+        Logistic::Stretch(order1.Predict(size_t(context1) * nodesCount + node)),
+        Logistic::Stretch(order2.Predict((size_t(context12) * nodesCount + node) & order2Mask)),
+        (level == CodecSettings::Max) ? Logistic::Stretch(zeroRun.Predict(size_t(runContext) * nodesCount + node)) : 0,
+        256
+    };
+    for (const int input : inputs) mixer.Add(input);
+    mixer.SetContext(context1 * nodeClassesCount + nodeClass);
+
+    uint32_t mixed = mixer.Mix();
+    if (level == CodecSettings::Max) {
+        for (const int input : inputs) runMixer.Add(input);
+        runMixer.SetContext(runContext * nodeClassesCount + nodeClass);
+        mixed = Logistic::Squash((Logistic::Stretch(mixed) + Logistic::Stretch(runMixer.Mix())) / 2);
+    }
+    const uint32_t refined1 = order1Apm.Refine(mixed, context1 * nodeClassesCount + nodeClass);
+    if (level == CodecSettings::Max) {
+        const uint32_t refined2 = order2Apm.Refine(mixed, context12 * nodeClassesCount + nodeClass);
+        probability = (2 * mixed + 3 * refined1 + 3 * refined2) >> 3;
+    } else {
+        probability = (mixed + 3 * refined1) >> 2;
+    }
+    probability = std::min<uint32_t>(std::max<uint32_t>(probability, 1), 4095);
+    return probability;
+}
+
+template <typename charType>
+void CodecCM<charType>::context_model::Update(const int bit)
+{
+    order0.Update(bit);
+    order1.Update(bit);
+    order2.Update(bit);
+    if (level == CodecSettings::Max) {
+        zeroRun.Update(bit);
+        runMixer.Update(bit);
+        order2Apm.Update(bit);
+    }
+    mixer.Update(bit);
+    order1Apm.Update(bit);
+}
+
+template <typename charType>
+void CodecCM<charType>::context_model::EndSymbol(const uint64_t value)
+{
+    context2 = context1;
+    context1 = symbolContext(value);
+    zeroRunLength = (value == 0) ? zeroRunLength + 1 : 0;
+}
+
+template <typename charType>
+uint32_t CodecCM<charType>::bucketOf(const uint64_t value)
+{
+    uint32_t bucket = 0;
+    while ((value >> bucket) != 0) ++bucket;
+    return bucket;
+}
+
+template <typename charType>
+uint32_t CodecCM<charType>::symbolContext(const uint64_t value)
+{
+    if (value < 16) return static_cast<uint32_t>(value);
+    return std::min<uint32_t>(11 + bucketOf(value), symbolContextsCount - 1);
+}
+
+template <typename charType>
+size_t CodecCM<charType>::order2Size()
+{
+    size_t size = 1;
+    while ((size < size_t(symbolContextsCount) * symbolContextsCount * nodesCount) && (size < (size_t(1) << maxOrder2Bits))) {
+        size <<= 1;
+    }
+    return size;
+}
+
+template <typename charType>
+template <typename bitFunction>
+uint64_t CodecCM<charType>::codeValue(context_model& model, bitFunction&& codeBit, const uint64_t value)
+{
+    const uint32_t bucket = bucketOf(value);
+    uint32_t codedBucket = 0;
+    while (codedBucket < maxBucket) {
+        model.SetNode(codedBucket);
+        if (!codeBit(model, bucket > codedBucket ? 1 : 0)) break;
+        ++codedBucket;
+    }
+
+    uint64_t codedValue = (codedBucket > 0) ? 1 : 0;
+    for (uint32_t j = 0; j + 1 < codedBucket; ++j) {
+        const uint32_t prefix = (j < 2) ? static_cast<uint32_t>(codedValue & 3) : 0;
+        model.SetNode(unaryNodesCount + ((codedBucket * maxBucket + j) << 2) + prefix);
+        const int bit = codeBit(model, static_cast<int>((value >> (codedBucket - 2 - j)) & 1));
+        codedValue = (codedValue << 1) | bit;
+    }
+
+    model.EndSymbol(codedValue);
+    return codedValue;
+}
+
+template <typename charType>
+typename CodecCM<charType>::data CodecCM<charType>::encodeToData(const StringL<charType>& inputStr)
+{
+    const CodecSettings::CMLevel level = CodecSettings::GetCMLevel();
+    if (inputStr.size() < 1) {
+        return data(0, level, Array<uint8_t>());
+    }
+
+    Array<uint8_t> encodedBytes(inputStr.size() / 4 + 16);
+    RangeEncoder encoder(encodedBytes);
+    context_model model(level);
+    auto encodeBit = [&encoder](context_model& model, const int bit) {
+        encoder.EncodeBit(model.Predict(), bit);
+        model.Update(bit);
+        return bit;
+    };
+
+    for (const charType& c : inputStr) {
+        codeValue(model, encodeBit, static_cast<valueType>(c));
+    }
+    encoder.Flush();
+
+    return data(inputStr.size(), level, encodedBytes);
+}
+
+template <typename charType>
+void CodecCM<charType>::encodeData(std::ofstream& outputFile, const data& data, const bool useUTF8)
+{
+    FileUtils::AppendValueBinary(outputFile, data.inputStrLength);
+    if (data.inputStrLength < 1) return;
+
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint8_t>(data.level));
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint32_t>(data.encodedBytes.size()));
+    outputFile.write(reinterpret_cast<const char*>(data.encodedBytes.begin()), data.encodedBytes.size());
+}
+
+template <typename charType>
+StringL<charType> CodecCM<charType>::decodeData(const data& data)
+{
+    if (data.inputStrLength < 1) {
+        return StringL<charType>();
+    }
+
+    StringL<charType> decodedStr(data.inputStrLength);
+
+    RangeDecoder decoder(data.encodedBytes.begin(), data.encodedBytes.end());
+    context_model model(data.level);
+    auto decodeBit = [&decoder](context_model& model, const int) {
+        const int bit = decoder.DecodeBit(model.Predict());
+        model.Update(bit);
+        return bit;
+    };
+
+    for (uint32_t i = 0; i < data.inputStrLength; ++i) {
+        decodedStr.push_back(static_cast<charType>(static_cast<valueType>(codeValue(model, decodeBit, 0))));
+    }
+
+    return decodedStr;
+}
\ No newline at end of file
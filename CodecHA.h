@@ -2,18 +2,22 @@
 
 #include <cstdint>
 #include <map>
+#include <cmath>
+#include <algorithm>
+#include <type_traits>
 
 #include "../helpers/FileUtils.h"
 #include "../helpers/CodecUTF8.h"
 #include "../helpers/HuffmanTree.h"
-#include "../helpers/TextUtils.h"
-#include "../helpers/BinaryUtils.h"
 #include "../helpers/BitArray.h"
 #include "../helpers/StringL.h"
 #include "../helpers/Array.h"
 
 #include "../compressor/CompressorSettings.h"
 
+#include "HistogramUtils.h"
+#include "BitStream.h"
+
 template <typename charType>
 class CodecHA
 {
@@ -23,23 +27,64 @@ public:
 private:
     CodecHA() = default;
 
-    static void sortInParallel(Array<charType>& alphabet, Array<uint32_t>& frequencies);
-    static void encodeNumbersEffectively(std::ofstream& outputFile, const Array<uint32_t>& numbers);
-    static Array<uint32_t> decodeNumbersEffectively(std::ifstream& inputFile, const uint16_t numberOfElements);
+    enum BlockMode : uint8_t { NewTable = 0, RepeatTable = 1 };
+    enum AlphabetMode : uint8_t { Bitmap = 0, Ranges = 1 };
+    enum CodeLengthsMode : uint8_t { FixedWidth = 0, RunLength = 1 };
+
+    const static size_t sizeOfSubBlock = 1024;
+    const static uint32_t maxCodeLength = 32;
+    const static uint32_t maxTokenCodeLength = 7;
+    const static uint32_t shortRepeatMin = 3;
+    const static uint32_t shortRepeatBits = 2;
+    const static uint32_t longRepeatMin = shortRepeatMin + (1 << shortRepeatBits);
+    const static uint32_t longRepeatBits = 7;
+
+    struct decoding_table {
+        Array<uint32_t> symbols;
+        uint64_t firstCode[maxCodeLength + 1];
+        uint32_t firstIndex[maxCodeLength + 1];
+        uint32_t count[maxCodeLength + 1];
+    };
+
+    static uint16_t getSubBlockSize();
+    static Array<uint32_t> splitIntoBlocks(const StringL<charType>& inputStr);
+    static void encodeBlockHeader(std::ofstream& outputFile, const BlockMode blockMode, const uint32_t blockLength, const uint16_t subBlockSize);
+    static uint32_t decodeBlockHeader(std::ifstream& inputFile, uint8_t& blockMode, const uint16_t subBlockSize, const uint32_t remainingLength);
+    static double estimateBlockCost(const Array<uint32_t>& frequencies);
+    static void sortInParallel(Array<uint32_t>& symbols, Array<uint32_t>& frequencies);
+    static bool isPreviousTableCheaper(const Array<charType>& alphabet, const Array<uint32_t>& frequencies,
+        const std::map<charType, std::pair<uint32_t, uint32_t>>& previousCodesMap);
+    static Array<uint32_t> buildCodeLengths(const Array<uint32_t>& frequencies, const uint32_t maxLength);
+    static Array<uint32_t> sortByCodeLength(const Array<uint32_t>& codeLengths);
+    static Array<uint32_t> buildCanonicalCodes(const Array<uint32_t>& codeLengths);
+    static decoding_table buildDecodingTable(const Array<uint32_t>& codeLengths);
+    template <typename nextBitFunction>
+    static uint32_t decodeSymbol(const decoding_table& table, nextBitFunction&& nextBit);
+    static void encodeTable(std::ofstream& outputFile, const Array<charType>& alphabet, const Array<uint32_t>& codeLengths);
+    static void decodeTable(std::ifstream& inputFile, Array<charType>& alphabet, Array<uint32_t>& codeLengths);
+    static void encodeAlphabet(BitArray& header, const Array<charType>& alphabet);
+    static Array<charType> decodeAlphabet(BitReader& reader);
+    static void encodeCodeLengths(BitArray& header, const Array<uint32_t>& codeLengths);
+    static Array<uint32_t> decodeCodeLengths(BitReader& reader, const size_t count);
 protected:
     struct data_local {
-        uint16_t alphabetLength;
-        Array<typename HuffmanTree<charType>::CanonicalCode> codes;
+        bool repeatsPreviousTable;
+        uint32_t blockLength;
+        Array<charType> alphabet;
+        Array<uint32_t> codeLengths;
         BitArray encodedStr;
-        data_local(const uint16_t& _alphabetLength, const Array<typename HuffmanTree<charType>::CanonicalCode>& _codes, const BitArray& _encodedStr) : 
-            alphabetLength(_alphabetLength), codes(_codes), encodedStr(_encodedStr) {}
+        data_local(const uint32_t _blockLength, const Array<charType>& _alphabet, const Array<uint32_t>& _codeLengths, const BitArray& _encodedStr) :
+            repeatsPreviousTable(false), blockLength(_blockLength), alphabet(_alphabet), codeLengths(_codeLengths), encodedStr(_encodedStr) {}
+        data_local(const uint32_t _blockLength, const BitArray& _encodedStr) :
+            repeatsPreviousTable(true), blockLength(_blockLength), encodedStr(_encodedStr) {}
         data_local() = default;
     };
     struct data {
         uint32_t inputStrSize;
+        uint16_t subBlockSize;
         Array<data_local> localDataItems;
-        data(const uint32_t _inputStrSize, const Array<data_local>& _localDataItems) : 
-            inputStrSize(_inputStrSize), localDataItems(_localDataItems) {}
+        data(const uint32_t _inputStrSize, const uint16_t _subBlockSize, const Array<data_local>& _localDataItems) :
+            inputStrSize(_inputStrSize), subBlockSize(_subBlockSize), localDataItems(_localDataItems) {}
         data() = default;
     };
 
@@ -49,218 +94,544 @@ protected:
 };
 
 template <typename charType>
-void CodecHA<charType>::Encode(StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8)
+void CodecHA<charType>::Encode(StringL<charType>& inputStr, std::ofstream& outputFile, const bool)
 {
-    const size_t maxSizeOfBlock = CompressorSettings::GetHuffmanBlockSize(); 
-    StringL<charType> localString(maxSizeOfBlock); 
-    size_t stringPointer = 0; 
+    Array<uint32_t> blockLengths = splitIntoBlocks(inputStr);
+    size_t blockStart = 0;
     Array<charType> alphabet;
     Array<uint32_t> frequencies;
+    std::map<charType, std::pair<uint32_t, uint32_t>> huffmanCodesMap;
+
+    const uint16_t subBlockSize = getSubBlockSize();
 
     FileUtils::AppendValueBinary(outputFile, static_cast<uint32_t>(inputStr.size()));
+    FileUtils::AppendValueBinary(outputFile, subBlockSize);
 
-    while (stringPointer < inputStr.size()) {
-        localString.clear();
-        while ((localString.size() < maxSizeOfBlock) && (stringPointer < inputStr.size())) {
-            localString.push_back(inputStr[stringPointer++]);
-        }
+    for (const uint32_t& blockLength : blockLengths) {
+        const size_t blockEnd = blockStart + blockLength;
 
-        alphabet = TextUtils::GetAlphabet<charType>(localString);
-        frequencies = TextUtils::GetFrequenciesInt(localString, alphabet);
-        sortInParallel(alphabet, frequencies);
-        
-        HuffmanTree<charType> tree(alphabet, frequencies);
-        Array<typename HuffmanTree<charType>::CanonicalCode> huffmanCanonicalCodes = tree.GetCanonicalCodes(tree, alphabet.size());
+        HistogramUtils::Build(inputStr, blockStart, blockEnd, alphabet, frequencies);
 
-        std::map<charType, std::pair<uint32_t, uint32_t>> huffmanCodesMap;
-        for (const auto& canonicalCode : huffmanCanonicalCodes) {
-            huffmanCodesMap[canonicalCode.character] = {canonicalCode.code, canonicalCode.codeLength};
-        }
+        if (isPreviousTableCheaper(alphabet, frequencies, huffmanCodesMap)) {
+            encodeBlockHeader(outputFile, BlockMode::RepeatTable, blockLength, subBlockSize);
+        } else {
+            Array<uint32_t> codeLengths = buildCodeLengths(frequencies, maxCodeLength);
+            Array<uint32_t> codes = buildCanonicalCodes(codeLengths);
 
-        BitArray encodedStr;
-        uint32_t code, length;
-        for (const charType& localChar : localString) {
-            code = huffmanCodesMap[localChar].first;
-            length = huffmanCodesMap[localChar].second;
-            for (const char& bit : BinaryUtils::GetBinaryStringFromNumber(code, length)) {
-                encodedStr.push_back(bit);
+            huffmanCodesMap.clear();
+            for (size_t i = 0; i < alphabet.size(); ++i) {
+                huffmanCodesMap[alphabet[i]] = {codes[i], codeLengths[i]};
             }
+
+            encodeBlockHeader(outputFile, BlockMode::NewTable, blockLength, subBlockSize);
+            encodeTable(outputFile, alphabet, codeLengths);
         }
 
-        FileUtils::AppendValueBinary(outputFile, static_cast<uint16_t>(alphabet.size()));
-        Array<uint32_t> lengthsOfCodes(alphabet.size());
-        if (useUTF8) {
-            for (const auto& canonicalCode : huffmanCanonicalCodes) {
-                CodecUTF8::EncodeCharToBinaryFile(outputFile, canonicalCode.character);
-                lengthsOfCodes.push_back(canonicalCode.codeLength);
-            }
-        } else {
-            for (const auto& canonicalCode : huffmanCanonicalCodes) {
-                FileUtils::AppendValueBinary(outputFile, canonicalCode.character);
-                lengthsOfCodes.push_back(canonicalCode.codeLength);
-            }
+        BitArray encodedStr;
+        for (size_t i = blockStart; i < blockEnd; ++i) {
+            const std::pair<uint32_t, uint32_t>& code = huffmanCodesMap[inputStr[i]];
+            BitStream::AppendBits(encodedStr, code.first, code.second);
         }
-        encodeNumbersEffectively(outputFile, lengthsOfCodes);
+
         BitArray::to_file(outputFile, encodedStr);
+        blockStart = blockEnd;
     }
 }
 
 template <typename charType>
-StringL<charType> CodecHA<charType>::Decode(std::ifstream& inputFile, const bool useUTF8)
+StringL<charType> CodecHA<charType>::Decode(std::ifstream& inputFile, const bool)
 {
-    const size_t maxSizeOfBlock = CompressorSettings::GetHuffmanBlockSize();
-
     uint32_t inputStrSize = FileUtils::ReadValueBinary<uint32_t>(inputFile);
-    uint32_t localDataCount = inputStrSize / maxSizeOfBlock + 1;
-    uint32_t lastBlockSize = inputStrSize % maxSizeOfBlock;
-
-    StringL<charType> decodedStr(localDataCount * maxSizeOfBlock);
-    StringL<charType> decodedStrLocal(maxSizeOfBlock);
-
-    while (localDataCount-- > 0) {
-        uint16_t alphabetLength = FileUtils::ReadValueBinary<uint16_t>(inputFile);
-        Array<charType> alphabet(alphabetLength);
-        if (useUTF8) {
-            for (uint16_t i = 0; i < alphabetLength; ++i)
-                alphabet.push_back(CodecUTF8::DecodeCharFromBinaryFile<charType>(inputFile));
-        } else {
-            for (uint16_t i = 0; i < alphabetLength; ++i)
-                alphabet.push_back(FileUtils::ReadValueBinary<charType>(inputFile));
+    uint16_t subBlockSize = FileUtils::ReadValueBinary<uint16_t>(inputFile);
+
+    StringL<charType> decodedStr(inputStrSize);
+    Array<charType> alphabet;
+    decoding_table table;
+
+    while (decodedStr.size() < inputStrSize) {
+        uint8_t blockMode;
+        uint32_t localSize = decodeBlockHeader(inputFile, blockMode, subBlockSize, inputStrSize - decodedStr.size());
+        if (blockMode == BlockMode::NewTable) {
+            Array<uint32_t> codeLengths;
+            decodeTable(inputFile, alphabet, codeLengths);
+            table = buildDecodingTable(codeLengths);
+        } else if (table.symbols.size() == 0) {
+            throw std::runtime_error("CodecHA error: no table to repeat");
         }
 
-        Array<uint32_t> lengthsOfCodes = decodeNumbersEffectively(inputFile, alphabetLength);
-
-        std::map<std::pair<uint32_t, uint32_t>, charType> huffmanCodesMap;
-        std::pair<uint32_t, uint32_t> binRepresentation;
-        std::pair<uint32_t, uint32_t> temp;
-        bool isCodeUsed;
-        for (size_t i = 0; i < lengthsOfCodes.size(); ++i) {
-            uint32_t lengthOfCode = lengthsOfCodes[i];
-            for (uint32_t j = 0; j < 1000000000; ++j) {
-                binRepresentation = { j, lengthOfCode };
-                if (huffmanCodesMap.find(binRepresentation) == huffmanCodesMap.end()) {
-                    isCodeUsed = false;
-                    temp = binRepresentation;
-                    for (uint32_t _ = 0; _ < lengthOfCode; ++_) {
-                        temp.first >>= 1;
-                        --temp.second;
-                        if (huffmanCodesMap.find(temp) != huffmanCodesMap.end()) {
-                            isCodeUsed = true;
-                            break;
-                        }
-                    }
-                    if (!isCodeUsed) {
-                        huffmanCodesMap[binRepresentation] = alphabet[i];
-                        break;
-                    }
-                }
-            }
-        }       
+        BitReader reader(inputFile);
+        for (uint32_t i = 0; i < localSize; ++i) {
+            decodedStr.push_back(alphabet[decodeSymbol(table, [&reader]() { return reader.ReadBit(); })]);
+        }
+    }
 
-        size_t localSize = (localDataCount > 0) ? maxSizeOfBlock : lastBlockSize;
-        BitArray bitBuffer;
-        std::pair<uint32_t, uint32_t> currentCode = { 0, 0 };
-        decodedStrLocal.clear();
+    return decodedStr;
+}
 
-        size_t i = 0;
-        bitBuffer = BitArray::from_file(inputFile, 8);
-        while (decodedStrLocal.size() < localSize)
-        {
-            if (i == 8) {
-                bitBuffer = BitArray::from_file(inputFile, 8);
-                i = 0;
-            }
+template <typename charType>
+uint16_t CodecHA<charType>::getSubBlockSize()
+{
+    return static_cast<uint16_t>(std::min(CompressorSettings::GetHuffmanBlockSize(), sizeOfSubBlock));
+}
 
-            if (bitBuffer.get_bit(i++) == '0') {
-                currentCode.first <<= 1;
-            } else {
-                currentCode.first <<= 1;
-                ++currentCode.first;
+template <typename charType>
+Array<uint32_t> CodecHA<charType>::splitIntoBlocks(const StringL<charType>& inputStr)
+{
+    const size_t maxSizeOfBlock = CompressorSettings::GetHuffmanBlockSize();
+    const size_t subBlockSize = getSubBlockSize();
+
+    Array<uint32_t> blockLengths;
+    Array<charType> blockAlphabet, subBlockAlphabet, mergedAlphabet;
+    Array<uint32_t> blockFrequencies, subBlockFrequencies, mergedFrequencies;
+    size_t blockLength = 0;
+    double blockCost = 0.0;
+
+    for (size_t subBlockStart = 0; subBlockStart < inputStr.size(); subBlockStart += subBlockSize) {
+        const size_t subBlockLength = std::min(subBlockSize, inputStr.size() - subBlockStart);
+        HistogramUtils::Build(inputStr, subBlockStart, subBlockStart + subBlockLength, subBlockAlphabet, subBlockFrequencies);
+        double subBlockCost = estimateBlockCost(subBlockFrequencies);
+
+        if ((blockLength > 0) && (blockLength + subBlockLength <= maxSizeOfBlock)) {
+            HistogramUtils::Merge(blockAlphabet, blockFrequencies, subBlockAlphabet, subBlockFrequencies, mergedAlphabet, mergedFrequencies);
+            double mergedCost = estimateBlockCost(mergedFrequencies);
+            if (mergedCost <= blockCost + subBlockCost) {
+                blockAlphabet = mergedAlphabet;
+                blockFrequencies = mergedFrequencies;
+                blockLength += subBlockLength;
+                blockCost = mergedCost;
+                continue;
             }
-            ++currentCode.second;
+        }
 
-            if (huffmanCodesMap.find(currentCode) != huffmanCodesMap.end()) {
-                decodedStrLocal.push_back(huffmanCodesMap[currentCode]);
-                currentCode.first = 0;
-                currentCode.second = 0;
-            }
+        if (blockLength > 0) {
+            blockLengths.push_back(static_cast<uint32_t>(blockLength));
         }
+        blockAlphabet = subBlockAlphabet;
+        blockFrequencies = subBlockFrequencies;
+        blockLength = subBlockLength;
+        blockCost = subBlockCost;
+    }
+    if (blockLength > 0) {
+        blockLengths.push_back(static_cast<uint32_t>(blockLength));
+    }
+
+    return blockLengths;
+}
 
-        decodedStr.push_back(decodedStrLocal);
+template <typename charType>
+void CodecHA<charType>::encodeBlockHeader(std::ofstream& outputFile, const BlockMode blockMode, const uint32_t blockLength, const uint16_t subBlockSize)
+{
+    uint32_t subBlocksCount = (blockLength + subBlockSize - 1) / subBlockSize;
+    if (subBlocksCount < 128) {
+        FileUtils::AppendValueBinary(outputFile, static_cast<uint8_t>((subBlocksCount << 1) | blockMode));
+    } else {
+        FileUtils::AppendValueBinary(outputFile, static_cast<uint8_t>(blockMode));
+        FileUtils::AppendValueBinary(outputFile, subBlocksCount);
     }
+}
 
-    return decodedStr;
+template <typename charType>
+uint32_t CodecHA<charType>::decodeBlockHeader(std::ifstream& inputFile, uint8_t& blockMode, const uint16_t subBlockSize, const uint32_t remainingLength)
+{
+    uint8_t blockHeader = FileUtils::ReadValueBinary<uint8_t>(inputFile);
+    blockMode = blockHeader & 1;
+
+    uint32_t subBlocksCount = blockHeader >> 1;
+    if (subBlocksCount == 0) {
+        subBlocksCount = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    }
+    if ((subBlockSize == 0) || (subBlocksCount == 0)) {
+        throw std::runtime_error("CodecHA error: invalid block length");
+    }
+
+    return static_cast<uint32_t>(std::min<uint64_t>(static_cast<uint64_t>(subBlocksCount) * subBlockSize, remainingLength));
 }
 
 template <typename charType>
-void CodecHA<charType>::sortInParallel(Array<charType>& alphabet, Array<uint32_t>& frequencies)
+double CodecHA<charType>::estimateBlockCost(const Array<uint32_t>& frequencies)
 {
-    Array<std::pair<charType, uint32_t>> charFrequencyVector(alphabet.size());
-    for (size_t i = 0; i < alphabet.size(); ++i) {
-        charFrequencyVector.push_back({ alphabet[i], frequencies[i] });
+    uint64_t totalFrequency = 0;
+    for (const uint32_t& frequency : frequencies) {
+        totalFrequency += frequency;
+    }
+
+    double cost = 8 * (sizeof(uint8_t) + sizeof(uint8_t));
+    for (const uint32_t& frequency : frequencies) {
+        cost += frequency * std::max(1.0, std::log2(static_cast<double>(totalFrequency) / frequency));
+        cost += 4;
+    }
+    return cost;
+}
+
+template <typename charType>
+void CodecHA<charType>::sortInParallel(Array<uint32_t>& symbols, Array<uint32_t>& frequencies)
+{
+    Array<std::pair<uint32_t, uint32_t>> symbolFrequencyVector(symbols.size());
+    for (size_t i = 0; i < symbols.size(); ++i) {
+        symbolFrequencyVector.push_back({ symbols[i], frequencies[i] });
     }
-    std::sort(charFrequencyVector.begin(), charFrequencyVector.end(), 
-        [](const std::pair<charType, uint32_t>& a, const std::pair<charType, uint32_t>& b)
+    std::sort(symbolFrequencyVector.begin(), symbolFrequencyVector.end(),
+        [](const std::pair<uint32_t, uint32_t>& a, const std::pair<uint32_t, uint32_t>& b)
         { return a.second < b.second; });
-    
-    alphabet.clear(); frequencies.clear();
-    for (const auto& pair : charFrequencyVector) {
-        alphabet.push_back(pair.first);
+
+    symbols.clear(); frequencies.clear();
+    for (const auto& pair : symbolFrequencyVector) {
+        symbols.push_back(pair.first);
         frequencies.push_back(pair.second);
     }
 }
 
 template <typename charType>
-void CodecHA<charType>::encodeNumbersEffectively(std::ofstream& outputFile, const Array<uint32_t>& numbers)
+bool CodecHA<charType>::isPreviousTableCheaper(const Array<charType>& alphabet, const Array<uint32_t>& frequencies,
+    const std::map<charType, std::pair<uint32_t, uint32_t>>& previousCodesMap)
+{
+    if (previousCodesMap.empty()) return false;
+
+    double previousTableCost = 8 * sizeof(uint8_t);
+    for (size_t i = 0; i < alphabet.size(); ++i) {
+        auto previousCode = previousCodesMap.find(alphabet[i]);
+        if (previousCode == previousCodesMap.end()) return false;
+
+        previousTableCost += static_cast<double>(frequencies[i]) * previousCode->second.second;
+    }
+
+    return previousTableCost <= estimateBlockCost(frequencies);
+}
+
+template <typename charType>
+Array<uint32_t> CodecHA<charType>::buildCodeLengths(const Array<uint32_t>& frequencies, const uint32_t maxLength)
+{
+    Array<uint32_t> limitedFrequencies = frequencies;
+    while (true) {
+        Array<uint32_t> symbols, symbolFrequencies;
+        for (uint32_t i = 0; i < limitedFrequencies.size(); ++i) {
+            if (limitedFrequencies[i] > 0) {
+                symbols.push_back(i);
+                symbolFrequencies.push_back(limitedFrequencies[i]);
+            }
+        }
+        sortInParallel(symbols, symbolFrequencies);
+
+        HuffmanTree<uint32_t> tree(symbols, symbolFrequencies);
+        Array<typename HuffmanTree<uint32_t>::CanonicalCode> huffmanCanonicalCodes = tree.GetCanonicalCodes(tree, symbols.size());
+
+        Array<uint32_t> codeLengths(frequencies.size());
+        for (size_t i = 0; i < frequencies.size(); ++i) {
+            codeLengths.push_back(0);
+        }
+        uint32_t longestCode = 0;
+        for (const auto& canonicalCode : huffmanCanonicalCodes) {
+            const uint32_t codeLength = std::max<uint32_t>(1, canonicalCode.codeLength);
+            codeLengths.assign(canonicalCode.character, codeLength);
+            longestCode = std::max(longestCode, codeLength);
+        }
+        if (longestCode <= maxLength) {
+            return codeLengths;
+        }
+
+        for (size_t i = 0; i < limitedFrequencies.size(); ++i) {
+            if (limitedFrequencies[i] > 0) {
+                limitedFrequencies.assign(i, limitedFrequencies[i] / 2 + 1);
+            }
+        }
+    }
+}
+
+template <typename charType>
+Array<uint32_t> CodecHA<charType>::sortByCodeLength(const Array<uint32_t>& codeLengths)
+{
+    Array<uint32_t> order(codeLengths.size());
+    for (uint32_t i = 0; i < codeLengths.size(); ++i) {
+        if (codeLengths[i] > 0) order.push_back(i);
+    }
+    std::stable_sort(order.begin(), order.end(),
+        [&codeLengths](const uint32_t a, const uint32_t b) { return codeLengths[a] < codeLengths[b]; });
+    return order;
+}
+
+template <typename charType>
+Array<uint32_t> CodecHA<charType>::buildCanonicalCodes(const Array<uint32_t>& codeLengths)
+{
+    Array<uint32_t> codes(codeLengths.size());
+    for (size_t i = 0; i < codeLengths.size(); ++i) {
+        codes.push_back(0);
+    }
+
+    uint64_t code = 0;
+    uint32_t previousLength = 0;
+    for (const uint32_t& symbol : sortByCodeLength(codeLengths)) {
+        code <<= (codeLengths[symbol] - previousLength);
+        codes.assign(symbol, static_cast<uint32_t>(code++));
+        previousLength = codeLengths[symbol];
+    }
+    return codes;
+}
+
+template <typename charType>
+typename CodecHA<charType>::decoding_table CodecHA<charType>::buildDecodingTable(const Array<uint32_t>& codeLengths)
+{
+    decoding_table table;
+    std::fill(std::begin(table.count), std::end(table.count), 0);
+    for (const uint32_t& codeLength : codeLengths) {
+        if (codeLength > maxCodeLength) {
+            throw std::runtime_error("CodecHA error: invalid code length");
+        }
+        if (codeLength > 0) ++table.count[codeLength];
+    }
+
+    uint64_t code = 0;
+    uint32_t index = 0;
+    for (uint32_t length = 1; length <= maxCodeLength; ++length) {
+        table.firstCode[length] = code;
+        table.firstIndex[length] = index;
+        index += table.count[length];
+        code = (code + table.count[length]) << 1;
+    }
+
+    table.symbols = sortByCodeLength(codeLengths);
+    return table;
+}
+
+template <typename charType>
+template <typename nextBitFunction>
+uint32_t CodecHA<charType>::decodeSymbol(const decoding_table& table, nextBitFunction&& nextBit)
+{
+    uint64_t code = 0;
+    for (uint32_t length = 1; length <= maxCodeLength; ++length) {
+        code = (code << 1) | (nextBit() == '1' ? 1 : 0);
+        if (code - table.firstCode[length] < table.count[length]) {
+            return table.symbols[table.firstIndex[length] + static_cast<uint32_t>(code - table.firstCode[length])];
+        }
+    }
+    throw std::runtime_error("CodecHA error: invalid Huffman code");
+}
+
+template <typename charType>
+void CodecHA<charType>::encodeTable(std::ofstream& outputFile, const Array<charType>& alphabet, const Array<uint32_t>& codeLengths)
+{
+    BitArray header;
+    encodeAlphabet(header, alphabet);
+    encodeCodeLengths(header, codeLengths);
+    BitArray::to_file(outputFile, header);
+}
+
+template <typename charType>
+void CodecHA<charType>::decodeTable(std::ifstream& inputFile, Array<charType>& alphabet, Array<uint32_t>& codeLengths)
+{
+    BitReader reader(inputFile);
+    alphabet = decodeAlphabet(reader);
+    codeLengths = decodeCodeLengths(reader, alphabet.size());
+}
+
+template <typename charType>
+void CodecHA<charType>::encodeAlphabet(BitArray& header, const Array<charType>& alphabet)
 {
-    if (numbers.size() < 1) return;
+    BitStream::AppendGamma(header, static_cast<uint64_t>(static_cast<std::make_unsigned_t<charType>>(alphabet[0])) + 1);
+
+    Array<uint64_t> rangeLengths, rangeGaps;
+    uint64_t rangeLength = 1;
+    for (size_t i = 1; i < alphabet.size(); ++i) {
+        const uint64_t gap = static_cast<uint64_t>(static_cast<int64_t>(alphabet[i]) - static_cast<int64_t>(alphabet[i - 1]));
+        if (gap == 1) {
+            ++rangeLength;
+        } else {
+            rangeLengths.push_back(rangeLength);
+            rangeGaps.push_back(gap - 1);
+            rangeLength = 1;
+        }
+    }
+    rangeLengths.push_back(rangeLength);
 
-    uint32_t maxValue = 0;
-    for (uint32_t number : numbers) {
-        maxValue = std::max(maxValue, number);
+    BitArray ranges;
+    BitStream::AppendGamma(ranges, rangeLengths.size());
+    for (size_t i = 0; i < rangeLengths.size(); ++i) {
+        if (i > 0) BitStream::AppendGamma(ranges, rangeGaps[i - 1]);
+        BitStream::AppendGamma(ranges, rangeLengths[i]);
+    }
+
+    const uint64_t span = static_cast<uint64_t>(static_cast<int64_t>(alphabet[alphabet.size() - 1]) - static_cast<int64_t>(alphabet[0]));
+    if (span < ranges.size()) {
+        BitArray bitmap;
+        BitStream::AppendGamma(bitmap, span + 1);
+        size_t j = 1;
+        for (uint64_t offset = 1; offset <= span; ++offset) {
+            const bool isPresent = static_cast<uint64_t>(static_cast<int64_t>(alphabet[j]) - static_cast<int64_t>(alphabet[0])) == offset;
+            bitmap.push_back(isPresent ? '1' : '0');
+            if (isPresent) ++j;
+        }
+        if (bitmap.size() < ranges.size()) {
+            BitStream::AppendBits(header, AlphabetMode::Bitmap, 1);
+            BitStream::Append(header, bitmap);
+            return;
+        }
     }
 
-    uint32_t maxBits = std::floor(std::log2(maxValue)) + 1; 
+    BitStream::AppendBits(header, AlphabetMode::Ranges, 1);
+    BitStream::Append(header, ranges);
+}
+
+template <typename charType>
+Array<charType> CodecHA<charType>::decodeAlphabet(BitReader& reader)
+{
+    const uint64_t maxSpan = (uint64_t(1) << (8 * sizeof(charType))) - 1;
 
-    BitArray encoded(numbers.size() * maxBits);
-    for (const uint32_t& number : numbers) {
-        for (const char& bit : BinaryUtils::GetBinaryStringFromNumber(number, maxBits)) {
-            encoded.push_back(bit);
+    Array<charType> alphabet;
+    const charType firstSymbol = static_cast<charType>(reader.ReadGamma() - 1);
+    const int64_t first = static_cast<int64_t>(firstSymbol);
+    alphabet.push_back(firstSymbol);
+
+    if (reader.ReadBit() == '0') {
+        const uint64_t span = reader.ReadGamma() - 1;
+        if (span > maxSpan) {
+            throw std::runtime_error("CodecHA error: invalid alphabet");
+        }
+        for (uint64_t offset = 1; offset <= span; ++offset) {
+            if (reader.ReadBit() == '1') {
+                alphabet.push_back(static_cast<charType>(first + static_cast<int64_t>(offset)));
+            }
+        }
+    } else {
+        const uint64_t rangesCount = reader.ReadGamma();
+        uint64_t offset = 0;
+        for (uint64_t i = 0; i < rangesCount; ++i) {
+            if (i > 0) offset += reader.ReadGamma() + 1;
+            const uint64_t rangeLength = reader.ReadGamma();
+            if (offset + rangeLength - 1 > maxSpan) {
+                throw std::runtime_error("CodecHA error: invalid alphabet");
+            }
+            for (uint64_t j = (i > 0) ? 0 : 1; j < rangeLength; ++j) {
+                alphabet.push_back(static_cast<charType>(first + static_cast<int64_t>(offset + j)));
+            }
+            offset += rangeLength - 1;
         }
     }
 
-    FileUtils::AppendValueBinary(outputFile, static_cast<uint8_t>(maxBits));
-    BitArray::to_file(outputFile, encoded);
+    return alphabet;
 }
 
 template <typename charType>
-Array<uint32_t> CodecHA<charType>::decodeNumbersEffectively(std::ifstream& inputFile, const uint16_t numberOfElements)
+void CodecHA<charType>::encodeCodeLengths(BitArray& header, const Array<uint32_t>& codeLengths)
 {
-    if (numberOfElements < 1) return Array<uint32_t>();
-
-    uint8_t maxBits = FileUtils::ReadValueBinary<uint8_t>(inputFile);
-    uint32_t encodedSize = (numberOfElements * maxBits);
-
-    BitArray encoded = BitArray::from_file(inputFile, 
-        (encodedSize % 8 == 0) ? (encodedSize) : ((encodedSize / 8 + 1) * 8)
-    );
-
-    Array<uint32_t> numbers;
-    uint32_t value;
-    size_t i = 0;
-    while (numbers.size() < numberOfElements) {
-        value = 0;
-        for (uint8_t _ = 0; _ < maxBits; ++_) {
-            if (encoded.get_bit(i++) == '0') {
-                value <<= 1;
+    uint32_t maxLength = 0;
+    for (const uint32_t& codeLength : codeLengths) {
+        maxLength = std::max(maxLength, codeLength);
+    }
+
+    uint32_t width = 1;
+    while ((maxLength >> width) != 0) ++width;
+
+    BitArray fixedWidth;
+    BitStream::AppendBits(fixedWidth, width - 1, 3);
+    for (const uint32_t& codeLength : codeLengths) {
+        BitStream::AppendBits(fixedWidth, codeLength, width);
+    }
+
+    const uint32_t shortRepeatToken = maxLength, longRepeatToken = maxLength + 1;
+    const uint32_t longRepeatMax = longRepeatMin + (1 << longRepeatBits) - 1;
+
+    Array<uint32_t> tokens, extraValues;
+    Array<uint32_t> tokenFrequencies(maxLength + 2);
+    for (uint32_t t = 0; t < maxLength + 2; ++t) {
+        tokenFrequencies.push_back(0);
+    }
+    for (size_t i = 0; i < codeLengths.size();) {
+        const uint32_t codeLength = codeLengths[i++];
+        tokens.push_back(codeLength - 1);
+        extraValues.push_back(0);
+        while (true) {
+            uint32_t repeat = 0;
+            while ((i + repeat < codeLengths.size()) && (codeLengths[i + repeat] == codeLength) && (repeat < longRepeatMax)) ++repeat;
+            if (repeat >= longRepeatMin) {
+                tokens.push_back(longRepeatToken);
+                extraValues.push_back(repeat - longRepeatMin);
+            } else if (repeat >= shortRepeatMin) {
+                tokens.push_back(shortRepeatToken);
+                extraValues.push_back(repeat - shortRepeatMin);
             } else {
-                value <<= 1; value |= 1;
+                break;
             }
+            i += repeat;
+        }
+    }
+    for (const uint32_t& token : tokens) {
+        tokenFrequencies.assign(token, tokenFrequencies[token] + 1);
+    }
+
+    Array<uint32_t> tokenCodeLengths = buildCodeLengths(tokenFrequencies, maxTokenCodeLength);
+    Array<uint32_t> tokenCodes = buildCanonicalCodes(tokenCodeLengths);
+
+    BitArray runLength;
+    BitStream::AppendBits(runLength, maxLength - 1, 5);
+    for (const uint32_t& tokenCodeLength : tokenCodeLengths) {
+        BitStream::AppendBits(runLength, tokenCodeLength, 3);
+    }
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        BitStream::AppendBits(runLength, tokenCodes[tokens[i]], tokenCodeLengths[tokens[i]]);
+        if (tokens[i] == shortRepeatToken) {
+            BitStream::AppendBits(runLength, extraValues[i], shortRepeatBits);
+        } else if (tokens[i] == longRepeatToken) {
+            BitStream::AppendBits(runLength, extraValues[i], longRepeatBits);
         }
-        numbers.push_back(value);
     }
 
-    return numbers;
+    if (runLength.size() < fixedWidth.size()) {
+        BitStream::AppendBits(header, CodeLengthsMode::RunLength, 1);
+        BitStream::Append(header, runLength);
+    } else {
+        BitStream::AppendBits(header, CodeLengthsMode::FixedWidth, 1);
+        BitStream::Append(header, fixedWidth);
+    }
+}
+
+template <typename charType>
+Array<uint32_t> CodecHA<charType>::decodeCodeLengths(BitReader& reader, const size_t count)
+{
+    Array<uint32_t> codeLengths(count);
+
+    if (reader.ReadBit() == '0') {
+        const uint32_t width = static_cast<uint32_t>(reader.ReadBits(3)) + 1;
+        for (size_t i = 0; i < count; ++i) {
+            codeLengths.push_back(static_cast<uint32_t>(reader.ReadBits(width)));
+        }
+    } else {
+        const uint32_t maxLength = static_cast<uint32_t>(reader.ReadBits(5)) + 1;
+        const uint32_t shortRepeatToken = maxLength;
+
+        Array<uint32_t> tokenCodeLengths(maxLength + 2);
+        for (uint32_t t = 0; t < maxLength + 2; ++t) {
+            tokenCodeLengths.push_back(static_cast<uint32_t>(reader.ReadBits(3)));
+        }
+        decoding_table tokenTable = buildDecodingTable(tokenCodeLengths);
+
+        while (codeLengths.size() < count) {
+            const uint32_t token = decodeSymbol(tokenTable, [&reader]() { return reader.ReadBit(); });
+            if (token < maxLength) {
+                codeLengths.push_back(token + 1);
+                continue;
+            }
+            if (codeLengths.size() == 0) {
+                throw std::runtime_error("CodecHA error: invalid code lengths");
+            }
+            const uint32_t repeat = (token == shortRepeatToken) ?
+                shortRepeatMin + static_cast<uint32_t>(reader.ReadBits(shortRepeatBits)) :
+                longRepeatMin + static_cast<uint32_t>(reader.ReadBits(longRepeatBits));
+            const uint32_t previousLength = codeLengths[codeLengths.size() - 1];
+            for (uint32_t r = 0; r < repeat; ++r) {
+                codeLengths.push_back(previousLength);
+            }
+        }
+    }
+
+    if (codeLengths.size() != count) {
+        throw std::runtime_error("CodecHA error: invalid code lengths");
+    }
+    for (const uint32_t& codeLength : codeLengths) {
+        if ((codeLength == 0) || (codeLength > maxCodeLength)) {
+            throw std::runtime_error("CodecHA error: invalid code lengths");
+        }
+    }
+
+    return codeLengths;
 }
 
 template <typename charType>
@@ -268,67 +639,60 @@ typename CodecHA<charType>::data CodecHA<charType>::encodeToData(const StringL<c
 {
     Array<data_local> localDataItems;
 
-    const size_t maxSizeOfBlock = CompressorSettings::GetHuffmanBlockSize(); 
-    StringL<charType> localString(maxSizeOfBlock); 
-    size_t stringPointer = 0; 
+    Array<uint32_t> blockLengths = splitIntoBlocks(inputStr);
+    size_t blockStart = 0;
     Array<charType> alphabet;
-    Array<uint32_t> frequencies; 
+    Array<uint32_t> frequencies;
+    Array<uint32_t> codeLengths;
+    std::map<charType, std::pair<uint32_t, uint32_t>> huffmanCodesMap;
 
-    while (stringPointer < inputStr.size()) {
-        localString.clear();
-        while ((localString.size() < maxSizeOfBlock) && (stringPointer < inputStr.size())) {
-            localString.push_back(inputStr[stringPointer++]);
-        }
+    for (const uint32_t& blockLength : blockLengths) {
+        const size_t blockEnd = blockStart + blockLength;
 
-        alphabet = TextUtils::GetAlphabet(localString);
-        frequencies = TextUtils::GetFrequenciesInt(localString, alphabet);
-        sortInParallel(alphabet, frequencies);
+        HistogramUtils::Build(inputStr, blockStart, blockEnd, alphabet, frequencies);
 
-        HuffmanTree<charType> tree(alphabet, frequencies);
-        Array<typename HuffmanTree<charType>::CanonicalCode> huffmanCanonicalCodes = tree.GetCanonicalCodes(tree, alphabet.size());
+        bool repeatsPreviousTable = isPreviousTableCheaper(alphabet, frequencies, huffmanCodesMap);
+        if (!repeatsPreviousTable) {
+            codeLengths = buildCodeLengths(frequencies, maxCodeLength);
+            Array<uint32_t> codes = buildCanonicalCodes(codeLengths);
 
-        std::map<charType, std::pair<uint32_t, uint32_t>> huffmanCodesMap;
-        for (const auto& canonicalCode : huffmanCanonicalCodes) {
-            huffmanCodesMap[canonicalCode.character] = {canonicalCode.code, canonicalCode.codeLength};
+            huffmanCodesMap.clear();
+            for (size_t i = 0; i < alphabet.size(); ++i) {
+                huffmanCodesMap[alphabet[i]] = {codes[i], codeLengths[i]};
+            }
         }
 
         BitArray encodedStr;
-        uint32_t code, length;
-        for (const charType& localChar : localString) {
-            code = huffmanCodesMap[localChar].first;
-            length = huffmanCodesMap[localChar].second;
-            for (const char& bit : BinaryUtils::GetBinaryStringFromNumber(code, length)) {
-                encodedStr.push_back(bit);
-            }
+        for (size_t i = blockStart; i < blockEnd; ++i) {
+            const std::pair<uint32_t, uint32_t>& code = huffmanCodesMap[inputStr[i]];
+            BitStream::AppendBits(encodedStr, code.first, code.second);
         }
 
-        localDataItems.push_back(data_local(alphabet.size(), huffmanCanonicalCodes, encodedStr));
+        if (repeatsPreviousTable) {
+            localDataItems.push_back(data_local(blockLength, encodedStr));
+        } else {
+            localDataItems.push_back(data_local(blockLength, alphabet, codeLengths, encodedStr));
+        }
+        blockStart = blockEnd;
     }
-    
-    return data(inputStr.size(), localDataItems);
+
+    return data(inputStr.size(), getSubBlockSize(), localDataItems);
 }
 
 template <typename charType>
-void CodecHA<charType>::encodeData(std::ofstream& outputFile, const data& data, const bool useUTF8)
+void CodecHA<charType>::encodeData(std::ofstream& outputFile, const data& data, const bool)
 {
     FileUtils::AppendValueBinary(outputFile, data.inputStrSize);
+    FileUtils::AppendValueBinary(outputFile, data.subBlockSize);
 
-    for (const auto localData : data.localDataItems)
+    for (const auto& localData : data.localDataItems)
     {
-        FileUtils::AppendValueBinary(outputFile, localData.alphabetLength);
-        Array<uint32_t> lengthsOfCodes(localData.alphabetLength);
-        if (useUTF8) {
-            for (const auto& canonicalCode : localData.codes) {
-                CodecUTF8::EncodeCharToBinaryFile(outputFile, canonicalCode.character);
-                lengthsOfCodes.push_back(canonicalCode.codeLength);
-            }
+        if (localData.repeatsPreviousTable) {
+            encodeBlockHeader(outputFile, BlockMode::RepeatTable, localData.blockLength, data.subBlockSize);
         } else {
-            for (const auto& canonicalCode : localData.codes) {
-                FileUtils::AppendValueBinary(outputFile, canonicalCode.character);
-                lengthsOfCodes.push_back(canonicalCode.codeLength);
-            }
+            encodeBlockHeader(outputFile, BlockMode::NewTable, localData.blockLength, data.subBlockSize);
+            encodeTable(outputFile, localData.alphabet, localData.codeLengths);
         }
-        encodeNumbersEffectively(outputFile, lengthsOfCodes);
         BitArray::to_file(outputFile, localData.encodedStr);
     }
 }
@@ -336,65 +700,22 @@ void CodecHA<charType>::encodeData(std::ofstream& outputFile, const data& data,
 template <typename charType>
 StringL<charType> CodecHA<charType>::decodeData(const data& data)
 {
-    const size_t maxSizeOfBlock = CompressorSettings::GetHuffmanBlockSize();
-
-    uint32_t localDataCount = data.inputStrSize / maxSizeOfBlock + 1;
-    uint32_t lastBlockSize = data.inputStrSize % maxSizeOfBlock;
-    StringL<charType> decodedStr(localDataCount * maxSizeOfBlock);
-    StringL<charType> decodedStrLocal(maxSizeOfBlock);
+    StringL<charType> decodedStr(data.inputStrSize);
+    Array<charType> alphabet;
+    decoding_table table;
 
     for (const auto& localData : data.localDataItems) {
-        --localDataCount;
-        std::map<std::pair<uint32_t, uint32_t>, charType> huffmanCodesMap;
-        std::pair<uint32_t, uint32_t> binRepresentation;
-        std::pair<uint32_t, uint32_t> temp;
-        bool isCodeUsed;
-        for (size_t i = 0; i < localData.alphabetLength; ++i) {
-            uint32_t lengthOfCode = localData.codes[i].codeLength;
-            for (uint32_t j = 0; j < 1000000000; ++j) {
-                binRepresentation = { j, lengthOfCode };
-                if (huffmanCodesMap.find(binRepresentation) == huffmanCodesMap.end()) {
-                    isCodeUsed = false;
-                    temp = binRepresentation;
-                    for (uint32_t _ = 0; _ < lengthOfCode; ++_) {
-                        temp.first >>= 1;
-                        --temp.second;
-                        if (huffmanCodesMap.find(temp) != huffmanCodesMap.end()) {
-                            isCodeUsed = true;
-                            break;
-                        }
-                    }
-                    if (!isCodeUsed) {
-                        huffmanCodesMap[binRepresentation] = localData.codes[i].character;
-                        break;
-                    }
-                }
-            }
-        }   
-
-        size_t localSize = (localDataCount > 0) ? maxSizeOfBlock : lastBlockSize;
-        std::pair<uint32_t, uint32_t> currentCode = { 0, 0 };
-        decodedStrLocal.clear();
+        if (!localData.repeatsPreviousTable) {
+            alphabet = localData.alphabet;
+            table = buildDecodingTable(localData.codeLengths);
+        } else if (table.symbols.size() == 0) {
+            throw std::runtime_error("CodecHA error: no table to repeat");
+        }
 
         size_t i = 0;
-        while (decodedStrLocal.size() < localSize)
-        {          
-            if (localData.encodedStr.get_bit(i++) == '0') {
-                currentCode.first <<= 1;
-            } else {
-                currentCode.first <<= 1;
-                ++currentCode.first;
-            }
-            ++currentCode.second;
-
-            if (huffmanCodesMap.find(currentCode) != huffmanCodesMap.end()) {
-                decodedStrLocal.push_back(huffmanCodesMap[currentCode]);
-                currentCode.first = 0;
-                currentCode.second = 0;
-            }
+        for (uint32_t j = 0; j < localData.blockLength; ++j) {
+            decodedStr.push_back(alphabet[decodeSymbol(table, [&localData, &i]() { return localData.encodedStr.get_bit(i++); })]);
         }
-
-        decodedStr.push_back(decodedStrLocal);
     }
 
     return decodedStr;
@@ -1,6 +1,12 @@
 #pragma once
 
 #include <cstdint>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+#include <vector>
 
 #include "../helpers/FileUtils.h"
 #include "../helpers/CodecUTF8.h"
@@ -9,165 +15,1160 @@
 
 #include "../compressor/CompressorSettings.h"
 
+#include "CodecSettings.h"
+#include "MatchFinder.h"
+#include "MemoryUtils.h"
+#include "LZ77Dictionary.h"
+#include "ThreadPool.h"
+
+template <typename charType>
+class CodecLZ77
+{
+public:
+    static void Encode(const StringL<charType>& text, std::ofstream& outputFile, const bool useUTF8);
+    static StringL<charType> Decode(std::ifstream& inputFile, const bool useUTF8);
+    static void DecodeStream(std::ifstream& inputFile, const bool useUTF8, const std::function<void(const charType*, size_t)>& sink);
+    static void DecodeStream(std::ifstream& inputFile, const bool useUTF8, std::ofstream& outputFile);
+private:
+    CodecLZ77() = default;
+    static int find(const StringL<charType>& target, const StringL<charType>& original, const uint32_t startIndex, const uint32_t endIndex);
+    static uint32_t getWindowSize();
+
+    const static uint32_t maxWindowSize = 1 << 24;
+    const static uint32_t tokenFieldBits = 4;
+    const static uint32_t tokenFieldMask = (1 << tokenFieldBits) - 1;
+    const static uint32_t digitBits = (8 * sizeof(charType) - 1 < 15) ? (8 * sizeof(charType) - 1) : 15;
+    const static uint32_t maxNumberSymbols = (32 + digitBits - 1) / digitBits;
+    const static uint32_t costScale = 16;
+    const static uint32_t denseCostsSize = 1 << 16;
+    const static size_t streamBlockSize = 1 << 16;
+
+    static uint32_t numberSymbols(uint32_t value, uint64_t* symbols);
+    static uint32_t varIntLength(uint32_t value);
+    static uint32_t tokenFieldLength(const uint32_t value);
+    static uint32_t matchBytes(const uint32_t offset, const uint32_t length);
+    static void appendVarInt(std::ofstream& outputFile, uint32_t value);
+    template <typename sourceType>
+    static uint32_t readVarInt(sourceType nextByte);
+
+    enum Parse : uint8_t { Lazy, Optimal };
+
+    struct level_parameters {
+        Parse parse;
+        uint32_t searchDepth;
+        uint32_t lazySteps;
+        bool insertMatched;
+        uint32_t niceLength;
+    };
+
+    static level_parameters getLevelParameters(const uint8_t level);
+
+    struct output_cursor {
+        charType* history;
+        charType* current;
+        charType* end;
+        charType* limit;
+
+        bool full() const { return current == end; }
+        void putLiteral(const charType c);
+        void putLiterals(const void* literals, const size_t count);
+        void putMatch(const uint32_t offset, const uint32_t length);
+    };
+
+    struct output_buffer {
+        std::vector<charType> symbols;
+        size_t prefixLength;
+        size_t length;
+
+        output_buffer(const StringL<charType>& prefix, const uint32_t length);
+
+        output_cursor cursor(const size_t begin, const size_t end, const bool sharedHistory);
+        StringL<charType> toString() const;
+    };
+
+    struct token_reader {
+        const uint8_t* current;
+        const uint8_t* end;
+
+        uint8_t nextByte();
+        void readLiterals(output_cursor& output, const uint32_t count);
+    };
+
+    struct output_window {
+        std::function<void(const charType*, size_t)> sink;
+        std::vector<charType> symbols;
+        size_t windowSize;
+        size_t capacity;
+        size_t current;
+        size_t flushed;
+        uint64_t history;
+        uint64_t remaining;
+
+        output_window(const std::function<void(const charType*, size_t)>& sink, const size_t windowSize, const StringL<charType>& prefix);
+
+        bool full() const { return remaining == 0; }
+        void startChunk(const uint64_t length, const bool keepHistory);
+        void putLiteral(const charType c);
+        void putLiterals(const void* literals, size_t count);
+        void putMatch(const uint32_t offset, uint32_t length);
+        void flush();
+    private:
+        size_t room();
+        void advance(const size_t count);
+    };
+
+    struct stream_token_reader {
+        std::ifstream& inputFile;
+        std::vector<uint8_t> bytes;
+        size_t position;
+        size_t filled;
+        uint64_t remaining;
+        uint64_t consumed;
+
+        stream_token_reader(std::ifstream& inputFile, const uint64_t length) :
+            inputFile(inputFile), bytes(streamBlockSize), position(0), filled(0), remaining(length), consumed(0) {}
+
+        uint8_t nextByte();
+        void readLiterals(output_window& output, uint32_t count);
+    private:
+        void refill();
+    };
+
+    struct utf8_token_reader {
+        std::ifstream& inputFile;
+
+        uint8_t nextByte() { return FileUtils::ReadValueBinary<uint8_t>(inputFile); }
+        template <typename outputType>
+        void readLiterals(outputType& output, const uint32_t count);
+    };
+
+    template <typename readerType, typename outputType>
+    static void decodeSequences(readerType& reader, outputType& output);
+protected:
+    enum Coding : uint8_t { Raw, Pooled, Streams };
+
+    struct data;
+
+    struct token_writer {
+        std::ofstream& outputFile;
+        const bool useUTF8;
+        std::streampos indexPosition;
+        std::streampos tokensPosition;
+        Array<uint32_t> chunkEnds;
+
+        token_writer(std::ofstream& outputFile, const bool useUTF8) : outputFile(outputFile), useUTF8(useUTF8) {}
+
+        void writeHeader(const data& header);
+        void writeChunk(const data& chunk);
+        void finish(const data& header);
+    };
+
+    struct data {
+        uint32_t inputStrLength;
+        uint32_t chunkSize;
+        uint32_t dictionarySize;
+        uint32_t dictionaryId;
+        uint32_t longWindowSize;
+        Array<uint32_t> literalCounts;
+        Array<uint32_t> lengths;
+        Array<uint32_t> offsets;
+        StringL<charType> chars;
+
+        data() = default;
+        data(const uint32_t inputStrLength_, const uint32_t chunkSize_, const uint32_t dictionarySize_, const uint32_t dictionaryId_ = 0, const uint32_t longWindowSize_ = 0) :
+            inputStrLength(inputStrLength_), chunkSize(chunkSize_), dictionarySize(dictionarySize_), dictionaryId(dictionaryId_), longWindowSize(longWindowSize_),
+            chars(inputStrLength_) {}
+
+        uint32_t chunksCount() const;
+        uint32_t blockChunksCount() const;
+        bool sharedHistory() const { return (dictionarySize > 0) || (longWindowSize > 0); }
+        void appendMatch(uint32_t& literalsCount, const uint32_t offset, const uint32_t length);
+        void appendFinal(const uint32_t literalsCount);
+        void append(const data& chunk);
+        uint32_t appendOpen(const data& segment);
+        void appendHeaderTo(StringL<charType>& str) const;
+        void appendTokensTo(StringL<charType>& str) const;
+        void appendTokensFrom(const StringL<charType>& str, size_t position);
+        const StringL<charType> toString() const;
+        static const data fromString(const StringL<charType>& str, const uint32_t inputStrLength);
+    };
+
+    struct block_decoder {
+        const data& header;
+        output_buffer output;
+        uint32_t chunksDecoded;
+
+        explicit block_decoder(const data& header);
+
+        void decode(const data& block);
+        bool finished() const { return chunksDecoded == header.chunksCount(); }
+        StringL<charType> toString() const { return output.toString(); }
+    };
+
+    typedef typename LongDistanceMatchFinder<charType>::match long_match;
+
+    const static uint32_t entropyBlockSize = 1 << 20;
+    const static uint32_t directBuckets = 16;
+    const static uint32_t bucketsCount = directBuckets + 2 * (32 - 4);
+
+    static uint32_t readNumber(const StringL<charType>& str, size_t& position);
+    static uint32_t valueBucket(const uint32_t value);
+    static uint32_t bucketBase(const uint32_t bucket);
+    static uint32_t bucketExtraBits(const uint32_t bucket);
+
+    static data encodeHeader(const StringL<charType>& inputStr);
+    static uint32_t readHeader(std::ifstream& inputFile, data& header, Array<uint32_t>& chunkEnds);
+    template <typename consumerType>
+    static void encodeChunks(const StringL<charType>& inputStr, const data& header, const Coding coding, consumerType consume);
+    static data encodeToData(const StringL<charType>& inputStr, const Coding coding = Coding::Pooled);
+    static data encodeChunk(const charType* text, const size_t begin, const size_t end, const level_parameters& parameters, const Coding coding,
+        const std::vector<long_match>& longMatches);
+    static data encodeToDataLazy(const charType* text, const size_t begin, const size_t end, const level_parameters& parameters);
+    static data encodeToDataOptimal(const charType* text, const size_t begin, const size_t end, const level_parameters& parameters, const Coding coding);
+    static data encodeToDataReference(const StringL<charType>& inputStr);
+
+    struct cost_table {
+        std::vector<uint32_t> denseCosts;
+        std::unordered_map<uint64_t, uint32_t> sparseCosts;
+        uint32_t unseenCost = 0;
+
+        void build(const std::unordered_map<uint64_t, uint32_t>& counts, const size_t denseSize);
+        uint32_t symbolCost(const uint64_t symbol) const;
+    };
+
+    struct cost_model {
+        Coding coding;
+        cost_table literals;
+        cost_table literalCounts;
+        cost_table lengths;
+        cost_table offsets;
+
+        uint32_t numberCost(const uint32_t value) const;
+        uint32_t valueCost(const cost_table& table, const uint32_t value) const;
+        uint32_t sequenceCost(const uint32_t literalsCount) const;
+        uint32_t matchCost(const uint32_t offset, const uint32_t length) const;
+        uint32_t literalCost(const charType c) const;
+    };
+
+    static cost_model buildCostModel(const data& data, const Coding coding);
+    template <typename matchType>
+    static data parseOptimal(const charType* text, const size_t begin, const size_t end, const std::vector<matchType>& matches,
+        const std::vector<uint32_t>& matchStarts, const cost_model& costs, const uint32_t niceLength);
+    static void encodeData(std::ofstream& outputFile, const data& data, const bool useUTF8);
+    static StringL<charType> decodeData(const data& data);
+};
+
+template <typename charType>
+void CodecLZ77<charType>::Encode(const StringL<charType>& text, std::ofstream& outputFile, const bool useUTF8)
+{
+    const data header = encodeHeader(text);
+    token_writer writer(outputFile, useUTF8);
+    writer.writeHeader(header);
+    encodeChunks(text, header, Coding::Raw, [&writer](const data& chunk) { writer.writeChunk(chunk); });
+    writer.finish(header);
+}
+
+template <typename charType>
+StringL<charType> CodecLZ77<charType>::Decode(std::ifstream& inputFile, const bool useUTF8)
+{
+    data header;
+    Array<uint32_t> chunkEnds;
+    readHeader(inputFile, header, chunkEnds);
+    const uint32_t chunksCount = chunkEnds.size();
+
+    output_buffer output(LZ77Dictionary<charType>::Get(header.dictionaryId), header.inputStrLength);
+    const bool sharedHistory = header.sharedHistory();
+    auto chunkCursor = [&](const size_t i) {
+        const size_t begin = i * header.chunkSize;
+        return output.cursor(begin, std::min<size_t>(begin + header.chunkSize, header.inputStrLength), sharedHistory);
+    };
+
+    if (useUTF8) {
+        utf8_token_reader reader{ inputFile };
+        for (uint32_t i = 0; i < chunksCount; ++i) {
+            output_cursor cursor = chunkCursor(i);
+            decodeSequences(reader, cursor);
+        }
+        return output.toString();
+    }
+
+    std::vector<uint8_t> tokens((chunksCount > 0) ? chunkEnds[chunksCount - 1] : 0);
+    inputFile.read(reinterpret_cast<char*>(tokens.data()), tokens.size());
+    if (static_cast<size_t>(inputFile.gcount()) != tokens.size()) {
+        throw std::runtime_error("CodecLZ77 error: unexpected end of file");
+    }
+
+    auto decodeChunk = [&](const size_t i) {
+        token_reader reader{ tokens.data() + ((i > 0) ? chunkEnds[i - 1] : 0), tokens.data() + chunkEnds[i] };
+        output_cursor cursor = chunkCursor(i);
+        decodeSequences(reader, cursor);
+        if (reader.current != reader.end) {
+            throw std::runtime_error("CodecLZ77 error: invalid chunk index");
+        }
+    };
+    if (sharedHistory) {
+        for (uint32_t i = 0; i < chunksCount; ++i) {
+            decodeChunk(i);
+        }
+    } else {
+        ThreadPool::Shared()->ParallelFor(chunksCount, decodeChunk);
+    }
+
+    return output.toString();
+}
+
+template <typename charType>
+void CodecLZ77<charType>::DecodeStream(std::ifstream& inputFile, const bool useUTF8, const std::function<void(const charType*, size_t)>& sink)
+{
+    data header;
+    Array<uint32_t> chunkEnds;
+    const uint32_t windowSize = readHeader(inputFile, header, chunkEnds);
+    const uint32_t chunksCount = chunkEnds.size();
+
+    output_window output(sink, std::max<uint32_t>({ windowSize, header.longWindowSize, 1 }), LZ77Dictionary<charType>::Get(header.dictionaryId));
+    const bool sharedHistory = header.sharedHistory();
+    auto chunkLength = [&header](const size_t i) {
+        return std::min<uint64_t>(header.chunkSize, header.inputStrLength - uint64_t(i) * header.chunkSize);
+    };
+
+    if (useUTF8) {
+        utf8_token_reader reader{ inputFile };
+        for (uint32_t i = 0; i < chunksCount; ++i) {
+            output.startChunk(chunkLength(i), sharedHistory || (i == 0));
+            decodeSequences(reader, output);
+        }
+    } else {
+        stream_token_reader reader(inputFile, (chunksCount > 0) ? chunkEnds[chunksCount - 1] : 0);
+        for (uint32_t i = 0; i < chunksCount; ++i) {
+            output.startChunk(chunkLength(i), sharedHistory || (i == 0));
+            decodeSequences(reader, output);
+            if (reader.consumed != chunkEnds[i]) {
+                throw std::runtime_error("CodecLZ77 error: invalid chunk index");
+            }
+        }
+    }
+    output.flush();
+}
+
+template <typename charType>
+void CodecLZ77<charType>::DecodeStream(std::ifstream& inputFile, const bool useUTF8, std::ofstream& outputFile)
+{
+    DecodeStream(inputFile, useUTF8, [&outputFile](const charType* symbols, const size_t count) {
+        outputFile.write(reinterpret_cast<const char*>(symbols), count * sizeof(charType));
+    });
+}
+
+template <typename charType>
+uint32_t CodecLZ77<charType>::readHeader(std::ifstream& inputFile, data& header, Array<uint32_t>& chunkEnds)
+{
+    header.inputStrLength = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    const uint32_t windowSize = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    header.chunkSize = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    header.dictionarySize = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    header.dictionaryId = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    header.longWindowSize = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+
+    const uint32_t chunksCount = header.chunksCount();
+    chunkEnds.resize(chunksCount);
+    for (uint32_t i = 0; i < chunksCount; ++i) {
+        chunkEnds.push_back(FileUtils::ReadValueBinary<uint32_t>(inputFile));
+        if ((i > 0) && (chunkEnds[i] < chunkEnds[i - 1])) {
+            throw std::runtime_error("CodecLZ77 error: invalid chunk index");
+        }
+    }
+    return windowSize;
+}
+
+template <typename charType>
+template <typename readerType, typename outputType>
+void CodecLZ77<charType>::decodeSequences(readerType& reader, outputType& output)
+{
+    auto nextByte = [&reader]() { return reader.nextByte(); };
+    auto readField = [&nextByte](const uint32_t field) {
+        return (field == tokenFieldMask) ? field + readVarInt(nextByte) : field;
+    };
+
+    while (!output.full())
+    {
+        const uint8_t token = nextByte();
+        reader.readLiterals(output, readField(token >> tokenFieldBits));
+        if (output.full()) break;
+
+        const uint32_t length = readField(token & tokenFieldMask) + 1;
+        output.putMatch(readVarInt(nextByte) + 1, length);
+    }
+}
+
+template <typename charType>
+uint32_t CodecLZ77<charType>::numberSymbols(uint32_t value, uint64_t* symbols)
+{
+    uint32_t count = 0;
+    while (value >> digitBits) {
+        symbols[count++] = (value & ((uint32_t(1) << digitBits) - 1)) | (uint64_t(1) << digitBits);
+        value >>= digitBits;
+    }
+    symbols[count++] = value;
+    return count;
+}
+
+template <typename charType>
+uint32_t CodecLZ77<charType>::varIntLength(uint32_t value)
+{
+    uint32_t length = 1;
+    while (value >>= 7) ++length;
+    return length;
+}
+
+template <typename charType>
+uint32_t CodecLZ77<charType>::valueBucket(const uint32_t value)
+{
+    if (value < directBuckets) return value;
+
+    uint32_t highestBit = 0;
+    while ((value >> highestBit) > 1) ++highestBit;
+    return directBuckets + 2 * (highestBit - 4) + ((value >> (highestBit - 1)) & 1);
+}
+
+template <typename charType>
+uint32_t CodecLZ77<charType>::bucketBase(const uint32_t bucket)
+{
+    if (bucket < directBuckets) return bucket;
+    return (2 | ((bucket - directBuckets) & 1)) << bucketExtraBits(bucket);
+}
+
+template <typename charType>
+uint32_t CodecLZ77<charType>::bucketExtraBits(const uint32_t bucket)
+{
+    if (bucket < directBuckets) return 0;
+    return (bucket - directBuckets) / 2 + 3;
+}
+
+template <typename charType>
+uint32_t CodecLZ77<charType>::tokenFieldLength(const uint32_t value)
+{
+    return (value < tokenFieldMask) ? 0 : varIntLength(value - tokenFieldMask);
+}
+
+template <typename charType>
+uint32_t CodecLZ77<charType>::matchBytes(const uint32_t offset, const uint32_t length)
+{
+    return tokenFieldLength(length - 1) + varIntLength(offset - 1);
+}
+
+template <typename charType>
+void CodecLZ77<charType>::appendVarInt(std::ofstream& outputFile, uint32_t value)
+{
+    uint8_t bytes[5];
+    size_t count = 0;
+    while (value >= 0x80) {
+        bytes[count++] = static_cast<uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+    bytes[count++] = static_cast<uint8_t>(value);
+    outputFile.write(reinterpret_cast<const char*>(bytes), count);
+}
+
+template <typename charType>
+template <typename sourceType>
+uint32_t CodecLZ77<charType>::readVarInt(sourceType nextByte)
+{
+    uint32_t value = 0;
+    for (uint32_t shift = 0; shift < 32; shift += 7) {
+        const uint8_t byte = nextByte();
+        value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) return value;
+    }
+    throw std::runtime_error("CodecLZ77 error: invalid variable-length integer");
+}
+
+template <typename charType>
+CodecLZ77<charType>::output_buffer::output_buffer(const StringL<charType>& prefix, const uint32_t length) :
+    symbols(prefix.size() + length + MemoryUtils::wildCopySlack / sizeof(charType) + 1), prefixLength(prefix.size()), length(length)
+{
+    std::copy(prefix.begin(), prefix.end(), symbols.begin());
+}
+
+template <typename charType>
+typename CodecLZ77<charType>::output_cursor CodecLZ77<charType>::output_buffer::cursor(const size_t begin, const size_t end, const bool sharedHistory)
+{
+    charType* symbolsBegin = symbols.data() + prefixLength;
+    charType* history = (sharedHistory || (begin == 0)) ? symbols.data() : symbolsBegin + begin;
+    charType* limit = (sharedHistory || (end == length)) ? symbols.data() + symbols.size() : symbolsBegin + end;
+    return { history, symbolsBegin + begin, symbolsBegin + end, limit };
+}
+
+template <typename charType>
+StringL<charType> CodecLZ77<charType>::output_buffer::toString() const
+{
+    StringL<charType> result(length);
+    for (const charType* c = symbols.data() + prefixLength; c != symbols.data() + prefixLength + length; ++c) {
+        result.push_back(*c);
+    }
+    return result;
+}
+
+template <typename charType>
+void CodecLZ77<charType>::output_cursor::putLiteral(const charType c)
+{
+    if (current == end) {
+        throw std::runtime_error("CodecLZ77 error: token exceeds decoded length");
+    }
+    *current++ = c;
+}
+
+template <typename charType>
+void CodecLZ77<charType>::output_cursor::putLiterals(const void* literals, const size_t count)
+{
+    if (count > static_cast<size_t>(end - current)) {
+        throw std::runtime_error("CodecLZ77 error: token exceeds decoded length");
+    }
+    if (count > 0) {
+        std::memcpy(current, literals, count * sizeof(charType));
+        current += count;
+    }
+}
+
+template <typename charType>
+void CodecLZ77<charType>::output_cursor::putMatch(const uint32_t offset, const uint32_t length)
+{
+    if ((offset == 0) || (offset > static_cast<size_t>(current - history))) {
+        throw std::runtime_error("CodecLZ77 error: invalid match offset");
+    }
+    if ((length == 0) || (length > static_cast<size_t>(end - current))) {
+        throw std::runtime_error("CodecLZ77 error: token exceeds decoded length");
+    }
+    MemoryUtils::CopyMatch(current, offset, length, limit - current);
+    current += length;
+}
+
+template <typename charType>
+uint8_t CodecLZ77<charType>::token_reader::nextByte()
+{
+    if (current == end) {
+        throw std::runtime_error("CodecLZ77 error: unexpected end of tokens");
+    }
+    return *current++;
+}
+
+template <typename charType>
+void CodecLZ77<charType>::token_reader::readLiterals(output_cursor& output, const uint32_t count)
+{
+    const size_t bytes = size_t(count) * sizeof(charType);
+    if (bytes > static_cast<size_t>(end - current)) {
+        throw std::runtime_error("CodecLZ77 error: unexpected end of tokens");
+    }
+    output.putLiterals(current, count);
+    current += bytes;
+}
+
+template <typename charType>
+CodecLZ77<charType>::output_window::output_window(const std::function<void(const charType*, size_t)>& sink, const size_t windowSize, const StringL<charType>& prefix) :
+    sink(sink), symbols(windowSize + std::max(windowSize, size_t(streamBlockSize)) + MemoryUtils::wildCopySlack / sizeof(charType) + 1),
+    windowSize(windowSize), capacity(windowSize + std::max(windowSize, size_t(streamBlockSize))), current(0), flushed(0), history(0), remaining(0)
+{
+    const size_t prefixLength = std::min<size_t>(prefix.size(), windowSize);
+    std::copy(prefix.end() - prefixLength, prefix.end(), symbols.begin());
+    current = flushed = history = prefixLength;
+}
+
+template <typename charType>
+void CodecLZ77<charType>::output_window::startChunk(const uint64_t length, const bool keepHistory)
+{
+    if (!keepHistory) {
+        history = 0;
+    }
+    remaining = length;
+}
+
+template <typename charType>
+size_t CodecLZ77<charType>::output_window::room()
+{
+    if (current == capacity) {
+        flush();
+        const size_t kept = std::min(current, windowSize);
+        std::memmove(symbols.data(), symbols.data() + current - kept, kept * sizeof(charType));
+        current = flushed = kept;
+    }
+    return capacity - current;
+}
+
+template <typename charType>
+void CodecLZ77<charType>::output_window::advance(const size_t count)
+{
+    current += count;
+    history += count;
+    remaining -= count;
+}
+
+template <typename charType>
+void CodecLZ77<charType>::output_window::putLiteral(const charType c)
+{
+    if (remaining == 0) {
+        throw std::runtime_error("CodecLZ77 error: token exceeds decoded length");
+    }
+    room();
+    symbols[current] = c;
+    advance(1);
+}
+
+template <typename charType>
+void CodecLZ77<charType>::output_window::putLiterals(const void* literals, size_t count)
+{
+    if (count > remaining) {
+        throw std::runtime_error("CodecLZ77 error: token exceeds decoded length");
+    }
+    const charType* source = static_cast<const charType*>(literals);
+    while (count > 0) {
+        const size_t length = std::min(count, room());
+        std::memcpy(symbols.data() + current, source, length * sizeof(charType));
+        source += length;
+        count -= length;
+        advance(length);
+    }
+}
+
+template <typename charType>
+void CodecLZ77<charType>::output_window::putMatch(const uint32_t offset, uint32_t length)
+{
+    if ((length == 0) || (length > remaining)) {
+        throw std::runtime_error("CodecLZ77 error: token exceeds decoded length");
+    }
+    while (length > 0) {
+        const size_t available = room();
+        if ((offset == 0) || (offset > history) || (offset > current)) {
+            throw std::runtime_error("CodecLZ77 error: invalid match offset");
+        }
+        const uint32_t copied = static_cast<uint32_t>(std::min<size_t>(length, available));
+        MemoryUtils::CopyMatch(symbols.data() + current, offset, copied, symbols.size() - current);
+        length -= copied;
+        advance(copied);
+    }
+}
+
+template <typename charType>
+void CodecLZ77<charType>::output_window::flush()
+{
+    if (current > flushed) {
+        sink(symbols.data() + flushed, current - flushed);
+        flushed = current;
+    }
+}
+
+template <typename charType>
+uint8_t CodecLZ77<charType>::stream_token_reader::nextByte()
+{
+    if (position == filled) {
+        refill();
+    }
+    ++consumed;
+    return bytes[position++];
+}
+
+template <typename charType>
+void CodecLZ77<charType>::stream_token_reader::readLiterals(output_window& output, uint32_t count)
+{
+    while (count > 0) {
+        if (filled - position < sizeof(charType)) {
+            refill();
+        }
+        const uint32_t length = static_cast<uint32_t>(std::min<size_t>(count, (filled - position) / sizeof(charType)));
+        output.putLiterals(bytes.data() + position, length);
+        position += length * sizeof(charType);
+        consumed += length * sizeof(charType);
+        count -= length;
+    }
+}
+
+template <typename charType>
+void CodecLZ77<charType>::stream_token_reader::refill()
+{
+    std::memmove(bytes.data(), bytes.data() + position, filled - position);
+    filled -= position;
+    position = 0;
+
+    const size_t requested = static_cast<size_t>(std::min<uint64_t>(bytes.size() - filled, remaining));
+    inputFile.read(reinterpret_cast<char*>(bytes.data() + filled), requested);
+    const size_t received = static_cast<size_t>(inputFile.gcount());
+    filled += received;
+    remaining -= received;
+    if ((received == 0) || (received < requested)) {
+        throw std::runtime_error("CodecLZ77 error: unexpected end of tokens");
+    }
+}
+
+template <typename charType>
+template <typename outputType>
+void CodecLZ77<charType>::utf8_token_reader::readLiterals(outputType& output, const uint32_t count)
+{
+    for (uint32_t i = 0; i < count; ++i) {
+        output.putLiteral(CodecUTF8::DecodeCharFromBinaryFile<charType>(inputFile));
+    }
+}
+
+template <typename charType>
+int CodecLZ77<charType>::find(const StringL<charType>& target, const StringL<charType>& original, const uint32_t startIndex, const uint32_t endIndex)
+{
+    uint32_t i = startIndex;
+    uint32_t j = 0;
+    while (i < endIndex)
+    {
+        if (original[i] == target[j])
+        {
+            ++j;
+            if (j == target.size()) return i - j + 1;
+        }
+        else
+        {
+            i -= j;
+            j = 0u;
+        }
+
+        ++i;
+    }
+
+    return -1;
+}
+
+template <typename charType>
+uint32_t CodecLZ77<charType>::getWindowSize()
+{
+    return std::min<uint32_t>(CompressorSettings::GetLZ77SearchBufferSize(), uint32_t(maxWindowSize));
+}
+
+template <typename charType>
+typename CodecLZ77<charType>::level_parameters CodecLZ77<charType>::getLevelParameters(const uint8_t level)
+{
+    switch (level) {
+    case 1: return { Parse::Lazy, 1, 0, false, 32 };
+    case 2: return { Parse::Lazy, 4, 0, true, 32 };
+    case 3: return { Parse::Lazy, 16, 0, true, 64 };
+    case 4: return { Parse::Lazy, 16, 1, true, 64 };
+    case 5: return { Parse::Lazy, 32, 1, true, 128 };
+    case 6: return { Parse::Lazy, 64, 2, true, 128 };
+    case 7: return { Parse::Lazy, 256, 2, true, 256 };
+    case 8: return { Parse::Optimal, 32, 0, true, 128 };
+    case 9: return { Parse::Optimal, 256, 0, true, 256 };
+    default: throw std::runtime_error("CodecLZ77 error: unknown compression level");
+    }
+}
+
+template <typename charType>
+void CodecLZ77<charType>::cost_table::build(const std::unordered_map<uint64_t, uint32_t>& counts, const size_t denseSize)
+{
+    uint64_t total = 0;
+    for (const auto& count : counts) {
+        total += count.second;
+    }
+
+    const double totalBits = std::log2(static_cast<double>(std::max<uint64_t>(total, 1)));
+    unseenCost = static_cast<uint32_t>(costScale * (totalBits + 2));
+    denseCosts.assign(denseSize, unseenCost);
+    sparseCosts.clear();
+    for (const auto& count : counts) {
+        const uint32_t cost = static_cast<uint32_t>(costScale * std::max(1.0, totalBits - std::log2(static_cast<double>(count.second))));
+        if (count.first < denseSize) {
+            denseCosts[count.first] = cost;
+        } else {
+            sparseCosts[count.first] = cost;
+        }
+    }
+}
+
+template <typename charType>
+uint32_t CodecLZ77<charType>::cost_table::symbolCost(const uint64_t symbol) const
+{
+    if (symbol < denseCosts.size()) return denseCosts[symbol];
+    auto cost = sparseCosts.find(symbol);
+    return (cost != sparseCosts.end()) ? cost->second : unseenCost;
+}
+
+template <typename charType>
+uint32_t CodecLZ77<charType>::cost_model::numberCost(const uint32_t value) const
+{
+    uint64_t symbols[maxNumberSymbols];
+    uint32_t cost = 0;
+    const uint32_t symbolsCount = numberSymbols(value, symbols);
+    for (uint32_t i = 0; i < symbolsCount; ++i) {
+        cost += literals.symbolCost(symbols[i]);
+    }
+    return cost;
+}
+
+template <typename charType>
+uint32_t CodecLZ77<charType>::cost_model::valueCost(const cost_table& table, const uint32_t value) const
+{
+    const uint32_t bucket = valueBucket(value);
+    return table.symbolCost(bucket) + costScale * bucketExtraBits(bucket);
+}
+
 template <typename charType>
-class CodecLZ77
+uint32_t CodecLZ77<charType>::cost_model::sequenceCost(const uint32_t literalsCount) const
 {
-public:
-    static void Encode(const StringL<charType>& text, std::ofstream& outputFile, const bool useUTF8);
-    static StringL<charType> Decode(std::ifstream& inputFile, const bool useUTF8);
-private:
-    CodecLZ77() = default;
-    static int find(const StringL<charType>& target, const StringL<charType>& original, const uint32_t startIndex, const uint32_t endIndex);
+    switch (coding) {
+    case Coding::Raw: return costScale * 8 * (1 + tokenFieldLength(literalsCount));
+    case Coding::Pooled: return numberCost(literalsCount);
+    default: return valueCost(literalCounts, literalsCount);
+    }
+}
 
-    const static uint32_t lookaheadBufferSize = 128;
-protected:
-    struct data {
-        uint32_t inputStrLength;
-        Array<uint16_t> offsets;
-        Array<uint8_t> lengths;
-        StringL<charType> chars;
+template <typename charType>
+uint32_t CodecLZ77<charType>::cost_model::matchCost(const uint32_t offset, const uint32_t length) const
+{
+    switch (coding) {
+    case Coding::Raw: return costScale * 8 * matchBytes(offset, length);
+    case Coding::Pooled: return numberCost(length) + numberCost(offset - 1);
+    default: return valueCost(lengths, length) + valueCost(offsets, offset - 1);
+    }
+}
 
-        data() = default;
-        data(const uint32_t inputStrLength_, const Array<uint16_t>& offsets_, const Array<uint8_t>& lengths_, const StringL<charType> chars_) :
-            inputStrLength(inputStrLength_), lengths(lengths_), offsets(offsets_), chars(chars_) {}
+template <typename charType>
+uint32_t CodecLZ77<charType>::cost_model::literalCost(const charType c) const
+{
+    if (coding == Coding::Raw) {
+        return costScale * 8 * sizeof(charType);
+    }
+    return literals.symbolCost(static_cast<std::make_unsigned_t<charType>>(c));
+}
 
-        const StringL<charType> toString() const;
-        static const data fromString(const StringL<charType>& str, const uint32_t inputStrLength);
-    };
+template <typename charType>
+typename CodecLZ77<charType>::cost_model CodecLZ77<charType>::buildCostModel(const data& data, const Coding coding)
+{
+    cost_model costs;
+    costs.coding = coding;
+    if (coding == Coding::Raw) return costs;
 
-    static data encodeToData(const StringL<charType>& inputStr);
-    static void encodeData(std::ofstream& outputFile, const data& data, const bool useUTF8);
-    static StringL<charType> decodeData(const data& data);
-};
+    std::unordered_map<uint64_t, uint32_t> literalCounts, lengths, offsets;
+    for (const charType& c : data.chars) {
+        ++literalCounts[static_cast<std::make_unsigned_t<charType>>(c)];
+    }
+
+    if (coding == Coding::Pooled) {
+        uint64_t symbols[maxNumberSymbols];
+        auto countNumber = [&](const uint32_t value) {
+            const uint32_t symbolsCount = numberSymbols(value, symbols);
+            for (uint32_t k = 0; k < symbolsCount; ++k) {
+                ++literalCounts[symbols[k]];
+            }
+        };
+        for (size_t i = 0; i < data.literalCounts.size(); ++i) {
+            countNumber(data.literalCounts[i]);
+            countNumber(data.lengths[i]);
+            if (data.lengths[i] > 0) {
+                countNumber(data.offsets[i] - 1);
+            }
+        }
+        costs.literals.build(literalCounts, denseCostsSize);
+        return costs;
+    }
+
+    costs.literals.build(literalCounts, denseCostsSize);
+    literalCounts.clear();
+    for (size_t i = 0; i < data.literalCounts.size(); ++i) {
+        ++literalCounts[valueBucket(data.literalCounts[i])];
+        ++lengths[valueBucket(data.lengths[i])];
+        if (data.lengths[i] > 0) {
+            ++offsets[valueBucket(data.offsets[i] - 1)];
+        }
+    }
+    costs.literalCounts.build(literalCounts, bucketsCount);
+    costs.lengths.build(lengths, bucketsCount);
+    costs.offsets.build(offsets, bucketsCount);
+    return costs;
+}
 
 template <typename charType>
-void CodecLZ77<charType>::Encode(const StringL<charType>& text, std::ofstream& outputFile, const bool useUTF8)
+typename CodecLZ77<charType>::data CodecLZ77<charType>::encodeHeader(const StringL<charType>& text)
 {
-    FileUtils::AppendValueBinary(outputFile, static_cast<uint32_t>(text.size()));
+    const uint32_t chunkSize = CodecSettings::GetLZ77ChunkSize();
+    const bool chunked = (chunkSize > 0) && (text.size() > chunkSize);
 
-    const uint32_t searchBufferSize = CompressorSettings::GetLZ77SearchBufferSize();
-    const uint32_t lookaheadBufferSize = CodecLZ77<charType>::lookaheadBufferSize;
+    data header;
+    header.inputStrLength = text.size();
+    header.chunkSize = chunked ? chunkSize : static_cast<uint32_t>(text.size());
+    header.dictionarySize = chunked ? std::min(CodecSettings::GetLZ77DictionarySize(), getWindowSize()) : 0;
+    header.dictionaryId = CodecSettings::GetLZ77DictionaryId();
+    header.longWindowSize = (CodecSettings::GetLZ77LongWindowSize() > getWindowSize()) ? CodecSettings::GetLZ77LongWindowSize() : 0;
+    return header;
+}
 
-    uint32_t i = 0; 
+template <typename charType>
+template <typename consumerType>
+void CodecLZ77<charType>::encodeChunks(const StringL<charType>& text, const data& header, const Coding coding, consumerType consume)
+{
+    const uint32_t chunksCount = header.chunksCount();
+    if (chunksCount < 1) return;
 
-    while (i < text.size())
-    {
-        StringL<charType> maxStr(lookaheadBufferSize); 
-        bool flag = true; 
+    const level_parameters parameters = getLevelParameters(CodecSettings::GetLZ77Level());
+    const StringL<charType>& prefix = LZ77Dictionary<charType>::Get(header.dictionaryId);
 
-        uint32_t searchBufferStart = (i > searchBufferSize) ? (i - searchBufferSize) : (0u);
-        uint32_t searchBufferEnd = i;
-        uint32_t offset = 0;
-        uint8_t length = 0;
-        int32_t index = searchBufferStart;
+    const charType* symbols = &*text.begin();
+    std::vector<charType> stitched;
+    if (prefix.size() > 0) {
+        const size_t stitchedLength = std::min<size_t>(text.size(), size_t(header.dictionarySize) + header.chunkSize);
+        stitched.reserve(prefix.size() + stitchedLength);
+        stitched.insert(stitched.end(), prefix.begin(), prefix.end());
+        stitched.insert(stitched.end(), symbols, symbols + stitchedLength);
+    }
 
-        while (flag && (i < text.size()) && (maxStr.size() < lookaheadBufferSize))
-        {
-            maxStr.push_back(text[i]);
+    std::vector<long_match> longMatches;
+    if (header.longWindowSize > 0) {
+        longMatches = LongDistanceMatchFinder<charType>(symbols, text.size(), header.longWindowSize).FindMatches(getWindowSize() + 1);
+    }
 
-            index = find(maxStr, text, index, searchBufferEnd);
-            if (index == -1)
-            {
-                break;
+    const std::shared_ptr<ThreadPool> pool = ThreadPool::Shared();
+    std::vector<data> batch(std::min<size_t>(pool->GetThreadsCount() + 1, chunksCount));
+    for (size_t batchBegin = 0; batchBegin < chunksCount; batchBegin += batch.size()) {
+        const size_t batchLength = std::min<size_t>(batch.size(), chunksCount - batchBegin);
+        pool->ParallelFor(batchLength, [&](const size_t k) {
+            const size_t begin = (batchBegin + k) * header.chunkSize;
+            const size_t history = (begin == 0) ? prefix.size() : std::min<size_t>(prefix.size() + begin, header.dictionarySize);
+            const size_t end = std::min<size_t>(begin + header.chunkSize, text.size());
+
+            std::vector<long_match> chunkMatches;
+            auto longMatch = std::partition_point(longMatches.begin(), longMatches.end(),
+                [begin](const long_match& m) { return m.position + m.length <= begin; });
+            for (; (longMatch != longMatches.end()) && (longMatch->position < end); ++longMatch) {
+                const size_t matchBegin = std::max(longMatch->position, begin);
+                const size_t matchEnd = std::min<size_t>(longMatch->position + longMatch->length, end);
+                if (matchEnd - matchBegin >= LongDistanceMatchFinder<charType>::minMatchLength) {
+                    chunkMatches.push_back({ history + matchBegin - begin, static_cast<uint32_t>(matchEnd - matchBegin), longMatch->offset });
+                }
             }
+            const charType* base = (begin < history) ? stitched.data() + prefix.size() : symbols;
+            batch[k] = encodeChunk(base + begin - history, history, history + end - begin, parameters, coding, chunkMatches);
+        });
+        for (size_t k = 0; k < batchLength; ++k) {
+            consume(batch[k]);
+            batch[k] = data();
+        }
+    }
+}
 
-            ++length;
-            offset = searchBufferEnd - index;
+template <typename charType>
+typename CodecLZ77<charType>::data CodecLZ77<charType>::encodeToData(const StringL<charType>& text, const Coding coding)
+{
+    data result = encodeHeader(text);
+    result.chars.resize(text.size());
+    encodeChunks(text, result, coding, [&result](const data& chunk) { result.append(chunk); });
+    return result;
+}
+
+template <typename charType>
+typename CodecLZ77<charType>::data CodecLZ77<charType>::encodeChunk(const charType* text, const size_t begin, const size_t end,
+    const level_parameters& parameters, const Coding coding, const std::vector<long_match>& longMatches)
+{
+    auto parse = [&](const charType* segmentText, const size_t segmentBegin, const size_t segmentEnd) {
+        if (parameters.parse == Parse::Optimal) {
+            return encodeToDataOptimal(segmentText, segmentBegin, segmentEnd, parameters, coding);
+        }
+        return encodeToDataLazy(segmentText, segmentBegin, segmentEnd, parameters);
+    };
+    if (longMatches.empty()) {
+        return parse(text, begin, end);
+    }
+
+    auto parseSegment = [&](const size_t segmentBegin, const size_t segmentEnd) {
+        const size_t history = std::min<size_t>(segmentBegin, getWindowSize());
+        return parse(text + segmentBegin - history, history, history + segmentEnd - segmentBegin);
+    };
+
+    data result(static_cast<uint32_t>(end - begin), static_cast<uint32_t>(end - begin), 0);
+    size_t position = begin;
+    for (const long_match& longMatch : longMatches) {
+        uint32_t literalsCount = (position < longMatch.position) ? result.appendOpen(parseSegment(position, longMatch.position)) : 0;
+        result.appendMatch(literalsCount, longMatch.offset, longMatch.length);
+        position = longMatch.position + longMatch.length;
+    }
+    if (position < end) {
+        result.append(parseSegment(position, end));
+    } else {
+        result.appendFinal(0);
+    }
+
+    return result;
+}
+
+template <typename charType>
+typename CodecLZ77<charType>::data CodecLZ77<charType>::encodeToDataOptimal(const charType* text, const size_t begin, const size_t end,
+    const level_parameters& parameters, const Coding coding)
+{
+    BinaryTreeMatchFinder<charType> matchFinder(text, end, getWindowSize(), parameters.niceLength, parameters.searchDepth, 1);
+    matchFinder.Skip(0, begin);
+
+    std::vector<typename BinaryTreeMatchFinder<charType>::match> matches, positionMatches;
+    std::vector<uint32_t> matchStarts(end - begin + 1);
+    for (size_t i = begin; i < end;) {
+        matchStarts[i - begin] = static_cast<uint32_t>(matches.size());
+        matchFinder.GetMatches(i, positionMatches);
+        matches.insert(matches.end(), positionMatches.begin(), positionMatches.end());
+        if (positionMatches.empty() || (positionMatches.back().length < parameters.niceLength)) {
             ++i;
+            continue;
         }
-        FileUtils::AppendValueBinary(outputFile, static_cast<uint16_t>(offset));
-        FileUtils::AppendValueBinary(outputFile, static_cast<uint8_t>(length));
-        if (length == 0) {
-            if (useUTF8) {
-                CodecUTF8::EncodeCharToBinaryFile(outputFile, text[i++]);
-            } else {
-                FileUtils::AppendValueBinary(outputFile, text[i++]);
-            }
+
+        auto& longest = matches.back();
+        const size_t extended = i + longest.length;
+        longest.length += MatchFinder<charType>::MatchLength(text + extended - longest.offset, text + extended, static_cast<uint32_t>(end - extended));
+        const size_t matchEnd = i + longest.length;
+        matchFinder.Skip(i + 1, matchEnd - i - 1);
+        for (++i; i < matchEnd; ++i) {
+            matchStarts[i - begin] = static_cast<uint32_t>(matches.size());
         }
     }
+    matchStarts[end - begin] = static_cast<uint32_t>(matches.size());
+
+    if (coding == Coding::Raw) {
+        return parseOptimal(text, begin, end, matches, matchStarts, buildCostModel(data(), coding), parameters.niceLength);
+    }
+
+    const level_parameters lazyParameters = { Parse::Lazy, parameters.searchDepth, 1, true, parameters.niceLength };
+    data parsed = parseOptimal(text, begin, end, matches, matchStarts, buildCostModel(encodeToDataLazy(text, begin, end, lazyParameters), coding), parameters.niceLength);
+    return parseOptimal(text, begin, end, matches, matchStarts, buildCostModel(parsed, coding), parameters.niceLength);
 }
 
 template <typename charType>
-StringL<charType> CodecLZ77<charType>::Decode(std::ifstream& inputFile, const bool useUTF8)
+template <typename matchType>
+typename CodecLZ77<charType>::data CodecLZ77<charType>::parseOptimal(const charType* text, const size_t begin, const size_t end,
+    const std::vector<matchType>& matches, const std::vector<uint32_t>& matchStarts, const cost_model& costs, const uint32_t niceLength)
 {
-    uint32_t inputStrLength = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    const size_t n = end - begin;
+    std::vector<uint64_t> prices(n + 1, UINT64_MAX);
+    std::vector<uint32_t> literalRuns(n + 1, 0);
+    std::vector<uint32_t> tokenLengths(n + 1, 0);
+    std::vector<uint32_t> tokenOffsets(n + 1, 0);
+    prices[0] = 0;
 
-    StringL<charType> decoded(inputStrLength);
-    uint32_t stringPointer = 0; 
+    for (size_t i = 0; i < n; ++i) {
+        const uint64_t literalPrice = prices[i] + costs.literalCost(text[begin + i]);
+        if (literalPrice < prices[i + 1]) {
+            prices[i + 1] = literalPrice;
+            literalRuns[i + 1] = literalRuns[i] + 1;
+            tokenLengths[i + 1] = 0;
+        }
 
-    uint32_t offset, length;
-    while (decoded.size() < inputStrLength)
-    {
-        offset = FileUtils::ReadValueBinary<uint16_t>(inputFile);
-        length = FileUtils::ReadValueBinary<uint8_t>(inputFile);
-        if (length == 0)
-        {
-            if (useUTF8) {
-                decoded.push_back(CodecUTF8::DecodeCharFromBinaryFile<charType>(inputFile));
-            } else {
-                decoded.push_back(FileUtils::ReadValueBinary<charType>(inputFile));
+        const uint64_t sequencePrice = prices[i] + costs.sequenceCost(literalRuns[i]);
+        uint32_t length = 1;
+        for (uint32_t m = matchStarts[i]; m < matchStarts[i + 1]; ++m) {
+            const uint32_t offset = matches[m].offset;
+            for (; length <= matches[m].length; ++length) {
+                if ((length > niceLength) && (length < matches[m].length)) {
+                    length = matches[m].length;
+                }
+                const uint64_t price = sequencePrice + costs.matchCost(offset, length);
+                if (price < prices[i + length]) {
+                    prices[i + length] = price;
+                    literalRuns[i + length] = 0;
+                    tokenLengths[i + length] = length;
+                    tokenOffsets[i + length] = offset;
+                }
             }
-            ++stringPointer;
         }
-        else
-        {
-            uint32_t start = stringPointer - offset;
-            uint32_t end = stringPointer - offset + length;
-            stringPointer += length;
-            for (uint32_t j = start; j < end; ++j) {
-                decoded.push_back(decoded[j]);
-            }
+    }
+
+    std::vector<size_t> tokenEnds;
+    for (size_t i = n; i > 0; i -= std::max<size_t>(tokenLengths[i], 1)) {
+        tokenEnds.push_back(i);
+    }
+
+    data result(static_cast<uint32_t>(n), static_cast<uint32_t>(n), 0);
+    uint32_t literalsCount = 0;
+    for (size_t k = tokenEnds.size(); k-- > 0;) {
+        const size_t tokenEnd = tokenEnds[k];
+        if (tokenLengths[tokenEnd] == 0) {
+            result.chars.push_back(text[begin + tokenEnd - 1]);
+            ++literalsCount;
+        } else {
+            result.appendMatch(literalsCount, tokenOffsets[tokenEnd], tokenLengths[tokenEnd]);
         }
     }
+    result.appendFinal(literalsCount);
 
-    return decoded;
+    return result;
 }
 
 template <typename charType>
-int CodecLZ77<charType>::find(const StringL<charType>& target, const StringL<charType>& original, const uint32_t startIndex, const uint32_t endIndex)
+typename CodecLZ77<charType>::data CodecLZ77<charType>::encodeToDataLazy(const charType* text, const size_t begin, const size_t end, const level_parameters& parameters)
 {
-    uint32_t i = startIndex;
-    uint32_t j = 0; 
-    while (i < endIndex)
-    {
-        if (original[i] == target[j])
-        {
-            ++j;
-            if (j == target.size()) return i - j + 1;
+    data result(static_cast<uint32_t>(end - begin), static_cast<uint32_t>(end - begin), 0);
+    uint32_t literalsCount = 0;
+
+    HashChainMatchFinder<charType> matchFinder(text, end, getWindowSize(), parameters.niceLength, parameters.searchDepth, 1);
+    typedef typename HashChainMatchFinder<charType>::match match;
+
+    const size_t probesCount = parameters.lazySteps + 1;
+    std::vector<match> probes(probesCount);
+    size_t probedEnd = 0;
+    auto probe = [&](const size_t position) {
+        if (position >= probedEnd) {
+            matchFinder.Skip(probedEnd, position - probedEnd);
+            match found = matchFinder.FindMatch(position);
+            if (found.length == parameters.niceLength) {
+                const size_t extended = position + found.length;
+                found.length += MatchFinder<charType>::MatchLength(text + extended - found.offset, text + extended, static_cast<uint32_t>(end - extended));
+            }
+            if ((found.length == 0) || (matchBytes(found.offset, found.length) + 1 > found.length * sizeof(charType))) {
+                found = { 0, 0 };
+            }
+            probes[position % probesCount] = found;
+            probedEnd = position + 1;
         }
-        else
-        {
-            i -= j;
-            j = 0u;
+        return probes[position % probesCount];
+    };
+
+    size_t i = begin;
+    while (i < end)
+    {
+        match current = probe(i);
+        for (uint32_t step = 1; (current.length > 0) && (current.length < parameters.niceLength) && (step <= parameters.lazySteps) && (i + step < end); ++step) {
+            const match next = probe(i + step);
+            if (next.length > 2 * current.length + step) {
+                for (uint32_t _ = 0; _ < step; ++_) {
+                    result.chars.push_back(text[i++]);
+                    ++literalsCount;
+                }
+                current = next;
+                step = 0;
+            }
         }
 
-        ++i;
+        if (current.length == 0) {
+            result.chars.push_back(text[i++]);
+            ++literalsCount;
+        } else {
+            result.appendMatch(literalsCount, current.offset, current.length);
+            i += current.length;
+            if (parameters.insertMatched) {
+                matchFinder.Skip(probedEnd, i - std::min(i, probedEnd));
+            }
+            probedEnd = std::max(probedEnd, i);
+        }
     }
+    result.appendFinal(literalsCount);
 
-    return -1;
+    return result;
 }
 
 template <typename charType>
-typename CodecLZ77<charType>::data CodecLZ77<charType>::encodeToData(const StringL<charType>& text)
+typename CodecLZ77<charType>::data CodecLZ77<charType>::encodeToDataReference(const StringL<charType>& text)
 {
-    const uint32_t searchBufferSize = CompressorSettings::GetLZ77SearchBufferSize();
-    const uint32_t lookaheadBufferSize = CodecLZ77<charType>::lookaheadBufferSize;
+    const uint32_t searchBufferSize = getWindowSize();
+    const uint32_t lookaheadBufferSize = getLevelParameters(CodecSettings::GetLZ77Level()).niceLength;
 
-    Array<uint8_t> lengths(text.size());
-    Array<uint16_t> offsets(text.size());
-    StringL<charType> chars(text.size());
+    data result(text.size(), text.size(), 0);
+    uint32_t literalsCount = 0;
+    if (text.size() < 1) return result;
 
-    uint32_t i = 0; 
+    uint32_t i = 0;
     while (i < text.size())
     {
-        StringL<charType> maxStr(lookaheadBufferSize); 
-        bool flag = true; 
+        StringL<charType> maxStr(lookaheadBufferSize);
+        bool flag = true;
 
         uint32_t searchBufferStart = (i > searchBufferSize) ? (i - searchBufferSize) : (0u);
         uint32_t searchBufferEnd = i;
         uint32_t offset = 0;
-        uint8_t length = 0;
-        int32_t index = searchBufferStart; 
+        uint32_t length = 0;
+        int32_t index = searchBufferStart;
 
         while (flag && (i < text.size()) && (maxStr.size() < lookaheadBufferSize))
         {
@@ -184,157 +1185,315 @@ typename CodecLZ77<charType>::data CodecLZ77<charType>::encodeToData(const Strin
             ++i;
         }
 
-        offsets.push_back(static_cast<uint16_t>(offset));
-        lengths.push_back(static_cast<uint8_t>(length));
-        if (length == 0) { chars.push_back(text[i++]); }
+        if (length == 0) {
+            result.chars.push_back(text[i++]);
+            ++literalsCount;
+        } else {
+            result.appendMatch(literalsCount, offset, length);
+        }
     }
-    
-    return data(text.size(), offsets, lengths, chars);
+    result.appendFinal(literalsCount);
+
+    return result;
 }
 
 template <typename charType>
-void CodecLZ77<charType>::encodeData(std::ofstream& outputFile, const data& data, const bool useUTF8)
+uint32_t CodecLZ77<charType>::data::chunksCount() const
 {
-    FileUtils::AppendValueBinary(outputFile, data.inputStrLength);
+    if (inputStrLength < 1) return 0;
+    if (chunkSize < 1) {
+        throw std::runtime_error("CodecLZ77 error: invalid chunk size");
+    }
+    return static_cast<uint32_t>((uint64_t(inputStrLength) + chunkSize - 1) / chunkSize);
+}
 
-    size_t charsPointer = 0;
+template <typename charType>
+uint32_t CodecLZ77<charType>::data::blockChunksCount() const
+{
+    return std::max<uint32_t>(1, entropyBlockSize / std::max<uint32_t>(1, chunkSize));
+}
+
+template <typename charType>
+void CodecLZ77<charType>::data::appendMatch(uint32_t& literalsCount, const uint32_t offset, const uint32_t length)
+{
+    literalCounts.push_back(literalsCount);
+    lengths.push_back(length);
+    offsets.push_back(offset);
+    literalsCount = 0;
+}
+
+template <typename charType>
+void CodecLZ77<charType>::data::appendFinal(const uint32_t literalsCount)
+{
+    literalCounts.push_back(literalsCount);
+    lengths.push_back(0);
+    offsets.push_back(0);
+}
+
+template <typename charType>
+void CodecLZ77<charType>::data::append(const data& chunk)
+{
+    for (size_t i = 0; i < chunk.literalCounts.size(); ++i) {
+        literalCounts.push_back(chunk.literalCounts[i]);
+        lengths.push_back(chunk.lengths[i]);
+        offsets.push_back(chunk.offsets[i]);
+    }
+    for (const charType& c : chunk.chars) {
+        chars.push_back(c);
+    }
+}
+
+template <typename charType>
+uint32_t CodecLZ77<charType>::data::appendOpen(const data& segment)
+{
+    const size_t last = segment.literalCounts.size() - 1;
+    for (size_t i = 0; i < last; ++i) {
+        literalCounts.push_back(segment.literalCounts[i]);
+        lengths.push_back(segment.lengths[i]);
+        offsets.push_back(segment.offsets[i]);
+    }
+    for (const charType& c : segment.chars) {
+        chars.push_back(c);
+    }
+    return segment.literalCounts[last];
+}
+
+template <typename charType>
+void CodecLZ77<charType>::token_writer::writeHeader(const data& header)
+{
+    FileUtils::AppendValueBinary(outputFile, header.inputStrLength);
+    FileUtils::AppendValueBinary(outputFile, getWindowSize());
+    FileUtils::AppendValueBinary(outputFile, header.chunkSize);
+    FileUtils::AppendValueBinary(outputFile, header.dictionarySize);
+    FileUtils::AppendValueBinary(outputFile, header.dictionaryId);
+    FileUtils::AppendValueBinary(outputFile, header.longWindowSize);
+
+    const uint32_t chunksCount = header.chunksCount();
+    indexPosition = outputFile.tellp();
+    for (uint32_t i = 0; i < chunksCount; ++i) {
+        FileUtils::AppendValueBinary(outputFile, uint32_t(0));
+    }
+    tokensPosition = outputFile.tellp();
+    chunkEnds.resize(chunksCount);
+}
 
-    for (uint32_t i = 0; i < data.lengths.size(); ++i)
+template <typename charType>
+void CodecLZ77<charType>::token_writer::writeChunk(const data& chunk)
+{
+    size_t charsPointer = 0;
+    for (size_t i = 0; i < chunk.literalCounts.size(); ++i)
     {
-        FileUtils::AppendValueBinary(outputFile, data.offsets[i]);
-        FileUtils::AppendValueBinary(outputFile, data.lengths[i]);
-        if (data.lengths[i] == 0) {
+        const uint32_t literalsCount = chunk.literalCounts[i];
+        const bool lastSequence = (chunk.lengths[i] == 0);
+        if (!lastSequence || (literalsCount > 0)) {
+            const uint32_t lengthField = lastSequence ? 0 : chunk.lengths[i] - 1;
+            outputFile.put(static_cast<char>((std::min(literalsCount, uint32_t(tokenFieldMask)) << tokenFieldBits) | std::min(lengthField, uint32_t(tokenFieldMask))));
+            if (literalsCount >= tokenFieldMask) {
+                appendVarInt(outputFile, literalsCount - tokenFieldMask);
+            }
             if (useUTF8) {
-                CodecUTF8::EncodeCharToBinaryFile(outputFile, data.chars[charsPointer++]);
+                for (uint32_t k = 0; k < literalsCount; ++k) {
+                    CodecUTF8::EncodeCharToBinaryFile(outputFile, chunk.chars[charsPointer++]);
+                }
             } else {
-                FileUtils::AppendValueBinary(outputFile, data.chars[charsPointer++]);
+                outputFile.write(reinterpret_cast<const char*>(chunk.chars.begin() + charsPointer), literalsCount * sizeof(charType));
+                charsPointer += literalsCount;
+            }
+
+            if (!lastSequence) {
+                if (lengthField >= tokenFieldMask) {
+                    appendVarInt(outputFile, lengthField - tokenFieldMask);
+                }
+                appendVarInt(outputFile, chunk.offsets[i] - 1);
             }
         }
+        if (lastSequence) {
+            chunkEnds.push_back(static_cast<uint32_t>(outputFile.tellp() - tokensPosition));
+        }
+    }
+}
+
+template <typename charType>
+void CodecLZ77<charType>::token_writer::finish(const data& header)
+{
+    if (chunkEnds.size() != header.chunksCount()) {
+        throw std::runtime_error("CodecLZ77 error: invalid chunk index");
+    }
+
+    const std::streampos endPosition = outputFile.tellp();
+    outputFile.seekp(indexPosition);
+    for (const uint32_t& chunkEnd : chunkEnds) {
+        FileUtils::AppendValueBinary(outputFile, chunkEnd);
     }
+    outputFile.seekp(endPosition);
+}
+
+template <typename charType>
+void CodecLZ77<charType>::encodeData(std::ofstream& outputFile, const data& data, const bool useUTF8)
+{
+    token_writer writer(outputFile, useUTF8);
+    writer.writeHeader(data);
+    writer.writeChunk(data);
+    writer.finish(data);
 }
 
 template <typename charType>
 StringL<charType> CodecLZ77<charType>::decodeData(const data& data)
 {
-    StringL<charType> decoded(data.inputStrLength);
+    block_decoder decoder(data);
+    decoder.decode(data);
+    if (!decoder.finished()) {
+        throw std::runtime_error("CodecLZ77 error: tokens do not match decoded length");
+    }
+    return decoder.toString();
+}
+
+template <typename charType>
+CodecLZ77<charType>::block_decoder::block_decoder(const data& header) :
+    header(header), output(LZ77Dictionary<charType>::Get(header.dictionaryId), header.inputStrLength), chunksDecoded(0)
+{
+}
+
+template <typename charType>
+void CodecLZ77<charType>::block_decoder::decode(const data& block)
+{
+    std::vector<size_t> sequenceStarts, charsStarts;
     size_t charsPointer = 0;
-    uint32_t stringPointer = 0; 
+    for (size_t i = 0; i < block.literalCounts.size(); ++i) {
+        if ((i == 0) || (block.lengths[i - 1] == 0)) {
+            sequenceStarts.push_back(i);
+            charsStarts.push_back(charsPointer);
+        }
+        charsPointer += block.literalCounts[i];
+    }
+    if ((sequenceStarts.size() > header.chunksCount() - chunksDecoded) || ((sequenceStarts.size() < 1) && !finished()) || (charsPointer > block.chars.size()) ||
+        ((block.lengths.size() > 0) && (block.lengths[block.lengths.size() - 1] != 0))) {
+        throw std::runtime_error("CodecLZ77 error: tokens do not match decoded length");
+    }
 
-    uint32_t i = 0;
-    while (decoded.size() < data.inputStrLength)
-    {
-        if (data.lengths[i] == 0)
-        {
-            decoded.push_back(data.chars[charsPointer++]);
-            ++stringPointer;
+    const bool sharedHistory = header.sharedHistory();
+    auto decodeChunk = [&](const size_t k) {
+        const size_t begin = (chunksDecoded + k) * header.chunkSize;
+        output_cursor cursor = output.cursor(begin, std::min<size_t>(begin + header.chunkSize, header.inputStrLength), sharedHistory);
+        const charType* chars = block.chars.begin() + charsStarts[k];
+        for (size_t i = sequenceStarts[k]; ; ++i) {
+            cursor.putLiterals(chars, block.literalCounts[i]);
+            chars += block.literalCounts[i];
+            if (block.lengths[i] == 0) break;
+            cursor.putMatch(block.offsets[i], block.lengths[i]);
         }
-        else
-        {
-            uint32_t start = stringPointer - data.offsets[i];
-            uint32_t end = stringPointer - data.offsets[i] + data.lengths[i];
-            stringPointer += data.lengths[i];
-            for (uint32_t j = start; j < end; ++j) {
-                decoded.push_back(decoded[j]);
-            }
+        if (!cursor.full()) {
+            throw std::runtime_error("CodecLZ77 error: tokens end before decoded length");
         }
-        ++i;
+    };
+    if (sharedHistory) {
+        for (size_t k = 0; k < sequenceStarts.size(); ++k) {
+            decodeChunk(k);
+        }
+    } else {
+        ThreadPool::Shared()->ParallelFor(sequenceStarts.size(), decodeChunk);
     }
-
-    return decoded;
+    chunksDecoded += static_cast<uint32_t>(sequenceStarts.size());
 }
 
+template <typename charType>
+void CodecLZ77<charType>::data::appendHeaderTo(StringL<charType>& str) const
+{
+    uint64_t symbols[maxNumberSymbols];
+    for (const uint32_t value : { chunkSize, dictionarySize, dictionaryId, longWindowSize }) {
+        const uint32_t symbolsCount = numberSymbols(value, symbols);
+        for (uint32_t k = 0; k < symbolsCount; ++k) {
+            str.push_back(static_cast<charType>(symbols[k]));
+        }
+    }
+}
 
 template <typename charType>
-const StringL<charType> CodecLZ77<charType>::data::toString() const
+void CodecLZ77<charType>::data::appendTokensTo(StringL<charType>& str) const
 {
-    StringL<charType> result(offsets.size() + lengths.size() + chars.size());
     size_t charsPointer = 0;
 
-    if (std::is_same<charType, unsigned char>::value)
-    {
-        for (size_t i = 0; i < lengths.size(); ++i)
-        {
-            result.push_back(static_cast<unsigned char>(offsets[i] >> 8));
-            result.push_back(static_cast<unsigned char>(offsets[i] & 0b11111111));
-            result.push_back(static_cast<unsigned char>(lengths[i]));
-            if (lengths[i] == 0) { result.push_back(chars[charsPointer++]); }
+    uint64_t symbols[maxNumberSymbols];
+    auto appendNumber = [&](const uint32_t value) {
+        const uint32_t symbolsCount = numberSymbols(value, symbols);
+        for (uint32_t k = 0; k < symbolsCount; ++k) {
+            str.push_back(static_cast<charType>(symbols[k]));
         }
-    }
-    else if ((std::is_same<charType, char16_t>::value) || (std::is_same<charType, unsigned short>::value))
+    };
+
+    for (size_t i = 0; i < literalCounts.size(); ++i)
     {
-        for (size_t i = 0; i < lengths.size(); ++i)
-        {
-            result.push_back(static_cast<unsigned short>(offsets[i]));
-            result.push_back(static_cast<unsigned short>(lengths[i]));
-            if (lengths[i] == 0) { result.push_back(chars[charsPointer++]); }
+        appendNumber(literalCounts[i]);
+        for (uint32_t k = 0; k < literalCounts[i]; ++k) {
+            str.push_back(chars[charsPointer++]);
         }
-    }
-    else if ((std::is_same<charType, char32_t>::value) || (std::is_same<charType, unsigned int>::value))
-    {
-        for (size_t i = 0; i < lengths.size(); ++i)
-        {
-            result.push_back(static_cast<unsigned int>((offsets[i] << 8) + lengths[i]));
-            if (lengths[i] == 0) { result.push_back(chars[charsPointer++]); }
+        appendNumber(lengths[i]);
+        if (lengths[i] > 0) {
+            appendNumber(offsets[i] - 1);
         }
     }
-    else
-    {
-        throw std::runtime_error("Error: Unsupported char type in CodecLZ77::data::toString()");
-    }
+}
 
+template <typename charType>
+const StringL<charType> CodecLZ77<charType>::data::toString() const
+{
+    StringL<charType> result(3 * literalCounts.size() + chars.size() + 4);
+    appendHeaderTo(result);
+    appendTokensTo(result);
     return result;
 }
 
 template <typename charType>
 const typename CodecLZ77<charType>::data CodecLZ77<charType>::data::fromString(const StringL<charType>& str, const uint32_t inputStrLength)
 {
+    size_t i = 0;
     data result;
     result.inputStrLength = inputStrLength;
-    result.offsets.resize(inputStrLength);
-    result.lengths.resize(inputStrLength);
-    result.chars.resize(inputStrLength);
-
-    uint16_t offset;
-    uint8_t length;
-    size_t i = 0; 
-    if (std::is_same<charType, unsigned char>::value)
+    result.chunkSize = readNumber(str, i);
+    result.dictionarySize = readNumber(str, i);
+    result.dictionaryId = readNumber(str, i);
+    result.longWindowSize = readNumber(str, i);
+    result.chars.resize(str.size() - i);
+    result.appendTokensFrom(str, i);
+    return result;
+}
+
+template <typename charType>
+void CodecLZ77<charType>::data::appendTokensFrom(const StringL<charType>& str, size_t position)
+{
+    while (position < str.size())
     {
-        while (i < str.size())
-        {
-            offset = (str[i] << 8) + str[i + 1];
-            length = str[i + 2];
-            result.offsets.push_back(offset);
-            result.lengths.push_back(length);
-            i += 3;
-            if (length == 0) { result.chars.push_back(str[i++]); }
+        uint32_t literalsCount = readNumber(str, position);
+        if (literalsCount > str.size() - position) {
+            throw std::runtime_error("CodecLZ77 error: invalid token string");
         }
-    }
-    else if ((std::is_same<charType, char16_t>::value) || (std::is_same<charType, unsigned short>::value))
-    {
-        while (i < str.size())
-        {
-            offset = static_cast<uint16_t>(str[i++]);
-            length = static_cast<uint8_t>(str[i++]);
-            result.lengths.push_back(length);
-            result.offsets.push_back(offset);
-            if (length == 0) { result.chars.push_back(str[i++]); }
+        for (uint32_t k = 0; k < literalsCount; ++k) {
+            chars.push_back(str[position++]);
+        }
+
+        const uint32_t length = readNumber(str, position);
+        if (length == 0) {
+            appendFinal(literalsCount);
+        } else {
+            appendMatch(literalsCount, readNumber(str, position) + 1, length);
         }
     }
-    else if ((std::is_same<charType, char32_t>::value) || (std::is_same<charType, unsigned int>::value))
-    {
-        while (i < str.size())
-        {
-            offset = static_cast<uint16_t>(str[i] & 0b00000000111111111111111100000000);
-            length = static_cast<uint8_t>(str[i++] & 0b00000000000000000000000011111111);
-            result.offsets.push_back(offset);
-            result.lengths.push_back(length);
-            if (length == 0) { result.chars.push_back(str[i++]); }
+}
+
+template <typename charType>
+uint32_t CodecLZ77<charType>::readNumber(const StringL<charType>& str, size_t& position)
+{
+    uint64_t value = 0;
+    for (uint32_t shift = 0; ; shift += digitBits) {
+        if ((position == str.size()) || (shift >= 32)) {
+            throw std::runtime_error("CodecLZ77 error: invalid token string");
         }
+        const uint64_t symbol = static_cast<std::make_unsigned_t<charType>>(str[position++]);
+        value |= (symbol & ((uint64_t(1) << digitBits) - 1)) << shift;
+        if ((symbol >> digitBits) == 0) break;
     }
-    else
-    {
-        throw std::runtime_error("Error: Unsupported char type in CodecLZ77::data::fromString()");
+    if (value > UINT32_MAX) {
+        throw std::runtime_error("CodecLZ77 error: invalid token string");
     }
-
-    return result;
+    return static_cast<uint32_t>(value);
 }
\ No newline at end of file
@@ -0,0 +1,307 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+
+#include "../helpers/FileUtils.h"
+#include "../helpers/CodecUTF8.h"
+#include "../helpers/StringL.h"
+
+#include "MatchFinder.h"
+#include "MemoryUtils.h"
+
+template <typename charType>
+class CodecLZFast
+{
+public:
+    static void Encode(const StringL<charType>& text, std::ofstream& outputFile, const bool useUTF8);
+    static StringL<charType> Decode(std::ifstream& inputFile, const bool useUTF8);
+private:
+    CodecLZFast() = default;
+
+    const static uint32_t hashBits = 14;
+    const static uint32_t skipTrigger = 6;
+    const static uint32_t maxOffset = UINT16_MAX;
+    const static uint32_t minMatchLength = (sizeof(charType) < sizeof(uint32_t)) ? sizeof(uint32_t) / sizeof(charType) : 1;
+    const static uint32_t tokenFieldBits = 4;
+    const static uint32_t tokenFieldMask = (1 << tokenFieldBits) - 1;
+
+    static uint32_t readWord(const charType* symbols);
+    static uint32_t hash(const charType* symbols);
+
+    struct buffer_writer {
+        std::vector<uint8_t>& bytes;
+
+        void putByte(const uint8_t byte) { bytes.push_back(byte); }
+        void putLiterals(const charType* literals, const size_t count);
+    };
+
+    struct utf8_writer {
+        std::ofstream& outputFile;
+
+        void putByte(const uint8_t byte) { outputFile.put(static_cast<char>(byte)); }
+        void putLiterals(const charType* literals, const size_t count);
+    };
+
+    struct buffer_reader {
+        const uint8_t* current;
+        const uint8_t* end;
+
+        uint8_t nextByte();
+        void readLiterals(charType* output, const size_t count);
+    };
+
+    struct utf8_reader {
+        std::ifstream& inputFile;
+
+        uint8_t nextByte() { return FileUtils::ReadValueBinary<uint8_t>(inputFile); }
+        void readLiterals(charType* output, const size_t count);
+    };
+
+    template <typename writerType>
+    static void putLength(writerType& writer, size_t length);
+    template <typename writerType>
+    static void putSequence(writerType& writer, const charType* literals, const size_t literalsCount, const uint32_t offset, const size_t length);
+    template <typename writerType>
+    static void encodeSequences(const StringL<charType>& text, writerType& writer);
+
+    template <typename readerType>
+    static size_t readLength(readerType& reader, const uint32_t field);
+    template <typename readerType>
+    static void decodeSequences(readerType& reader, std::vector<charType>& symbols, const size_t length);
+};
+
+template <typename charType>
+void CodecLZFast<charType>::Encode(const StringL<charType>& text, std::ofstream& outputFile, const bool useUTF8)
+{
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint32_t>(text.size()));
+    if (useUTF8) {
+        utf8_writer writer{ outputFile };
+        encodeSequences(text, writer);
+        return;
+    }
+
+    std::vector<uint8_t> tokens;
+    tokens.reserve(text.size() * sizeof(charType) + text.size() / 255 + 16);
+    buffer_writer writer{ tokens };
+    encodeSequences(text, writer);
+
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint32_t>(tokens.size()));
+    outputFile.write(reinterpret_cast<const char*>(tokens.data()), tokens.size());
+}
+
+template <typename charType>
+StringL<charType> CodecLZFast<charType>::Decode(std::ifstream& inputFile, const bool useUTF8)
+{
+    const uint32_t length = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    std::vector<charType> symbols(length + MemoryUtils::wildCopySlack / sizeof(charType) + 1);
+
+    if (useUTF8) {
+        utf8_reader reader{ inputFile };
+        decodeSequences(reader, symbols, length);
+    } else {
+        std::vector<uint8_t> tokens(FileUtils::ReadValueBinary<uint32_t>(inputFile) + MemoryUtils::wildCopySlack);
+        const size_t tokensLength = tokens.size() - MemoryUtils::wildCopySlack;
+        inputFile.read(reinterpret_cast<char*>(tokens.data()), tokensLength);
+        if (static_cast<size_t>(inputFile.gcount()) != tokensLength) {
+            throw std::runtime_error("CodecLZFast error: unexpected end of file");
+        }
+
+        buffer_reader reader{ tokens.data(), tokens.data() + tokensLength };
+        decodeSequences(reader, symbols, length);
+        if (reader.current != reader.end) {
+            throw std::runtime_error("CodecLZFast error: tokens exceed decoded length");
+        }
+    }
+
+    StringL<charType> result(length);
+    for (uint32_t i = 0; i < length; ++i) {
+        result.push_back(symbols[i]);
+    }
+    return result;
+}
+
+template <typename charType>
+uint32_t CodecLZFast<charType>::readWord(const charType* symbols)
+{
+    uint32_t word;
+    std::memcpy(&word, symbols, sizeof(uint32_t));
+    return word;
+}
+
+template <typename charType>
+uint32_t CodecLZFast<charType>::hash(const charType* symbols)
+{
+    return (readWord(symbols) * 2654435761u) >> (32 - hashBits);
+}
+
+template <typename charType>
+template <typename writerType>
+void CodecLZFast<charType>::encodeSequences(const StringL<charType>& text, writerType& writer)
+{
+    const size_t n = text.size();
+    if (n < 1) return;
+
+    const charType* symbols = &*text.begin();
+    std::vector<uint32_t> table(size_t(1) << hashBits, 0);
+    size_t anchor = 0;
+    size_t i = 1;
+    while (i + minMatchLength <= n)
+    {
+        size_t candidate = 0;
+        bool found = false;
+        for (uint32_t attempts = 1 << skipTrigger; i + minMatchLength <= n; i += attempts++ >> skipTrigger) {
+            uint32_t& slot = table[hash(symbols + i)];
+            candidate = slot;
+            slot = static_cast<uint32_t>(i);
+            if ((i - candidate <= maxOffset) && (readWord(symbols + candidate) == readWord(symbols + i))) {
+                found = true;
+                break;
+            }
+        }
+        if (!found) break;
+
+        while ((i > anchor) && (candidate > 0) && (symbols[i - 1] == symbols[candidate - 1])) {
+            --i;
+            --candidate;
+        }
+        const size_t length = minMatchLength + MatchFinder<charType>::MatchLength(symbols + candidate + minMatchLength, symbols + i + minMatchLength,
+            static_cast<uint32_t>(std::min<size_t>(n - i - minMatchLength, UINT32_MAX)));
+
+        putSequence(writer, symbols + anchor, i - anchor, static_cast<uint32_t>(i - candidate), length);
+        i += length;
+        anchor = i;
+        if (i + minMatchLength <= n) {
+            table[hash(symbols + i - 2)] = static_cast<uint32_t>(i - 2);
+        }
+    }
+
+    if (anchor < n) {
+        putSequence(writer, symbols + anchor, n - anchor, 0, 0);
+    }
+}
+
+template <typename charType>
+template <typename writerType>
+void CodecLZFast<charType>::putLength(writerType& writer, size_t length)
+{
+    while (length >= 255) {
+        writer.putByte(255);
+        length -= 255;
+    }
+    writer.putByte(static_cast<uint8_t>(length));
+}
+
+template <typename charType>
+template <typename writerType>
+void CodecLZFast<charType>::putSequence(writerType& writer, const charType* literals, const size_t literalsCount, const uint32_t offset, const size_t length)
+{
+    const size_t lengthField = (length > 0) ? length - minMatchLength : 0;
+    writer.putByte(static_cast<uint8_t>((std::min<size_t>(literalsCount, tokenFieldMask) << tokenFieldBits) | std::min<size_t>(lengthField, tokenFieldMask)));
+    if (literalsCount >= tokenFieldMask) {
+        putLength(writer, literalsCount - tokenFieldMask);
+    }
+    writer.putLiterals(literals, literalsCount);
+    if (length < 1) return;
+
+    writer.putByte(static_cast<uint8_t>(offset));
+    writer.putByte(static_cast<uint8_t>(offset >> 8));
+    if (lengthField >= tokenFieldMask) {
+        putLength(writer, lengthField - tokenFieldMask);
+    }
+}
+
+template <typename charType>
+template <typename readerType>
+size_t CodecLZFast<charType>::readLength(readerType& reader, const uint32_t field)
+{
+    size_t length = field;
+    if (field == tokenFieldMask) {
+        uint8_t byte;
+        do {
+            byte = reader.nextByte();
+            length += byte;
+        } while (byte == 255);
+    }
+    return length;
+}
+
+template <typename charType>
+template <typename readerType>
+void CodecLZFast<charType>::decodeSequences(readerType& reader, std::vector<charType>& symbols, const size_t length)
+{
+    charType* const begin = symbols.data();
+    charType* const end = begin + length;
+    charType* const limit = begin + symbols.size();
+    charType* current = begin;
+
+    while (current != end)
+    {
+        const uint8_t token = reader.nextByte();
+        const size_t literalsCount = readLength(reader, token >> tokenFieldBits);
+        if (literalsCount > static_cast<size_t>(end - current)) {
+            throw std::runtime_error("CodecLZFast error: token exceeds decoded length");
+        }
+        reader.readLiterals(current, literalsCount);
+        current += literalsCount;
+        if (current == end) break;
+
+        const uint32_t offset = reader.nextByte() | (uint32_t(reader.nextByte()) << 8);
+        const size_t matchLength = readLength(reader, token & tokenFieldMask) + minMatchLength;
+        if ((offset == 0) || (offset > static_cast<size_t>(current - begin))) {
+            throw std::runtime_error("CodecLZFast error: invalid match offset");
+        }
+        if (matchLength > static_cast<size_t>(end - current)) {
+            throw std::runtime_error("CodecLZFast error: token exceeds decoded length");
+        }
+        MemoryUtils::CopyMatch(current, offset, matchLength, limit - current);
+        current += matchLength;
+    }
+}
+
+template <typename charType>
+void CodecLZFast<charType>::buffer_writer::putLiterals(const charType* literals, const size_t count)
+{
+    const uint8_t* bytesBegin = reinterpret_cast<const uint8_t*>(literals);
+    bytes.insert(bytes.end(), bytesBegin, bytesBegin + count * sizeof(charType));
+}
+
+template <typename charType>
+void CodecLZFast<charType>::utf8_writer::putLiterals(const charType* literals, const size_t count)
+{
+    for (size_t k = 0; k < count; ++k) {
+        CodecUTF8::EncodeCharToBinaryFile(outputFile, literals[k]);
+    }
+}
+
+template <typename charType>
+uint8_t CodecLZFast<charType>::buffer_reader::nextByte()
+{
+    if (current == end) {
+        throw std::runtime_error("CodecLZFast error: unexpected end of tokens");
+    }
+    return *current++;
+}
+
+template <typename charType>
+void CodecLZFast<charType>::buffer_reader::readLiterals(charType* output, const size_t count)
+{
+    const size_t bytes = count * sizeof(charType);
+    if (bytes > static_cast<size_t>(end - current)) {
+        throw std::runtime_error("CodecLZFast error: unexpected end of tokens");
+    }
+    if (bytes > 0) {
+        MemoryUtils::WildCopy(output, current, bytes);
+        current += bytes;
+    }
+}
+
+template <typename charType>
+void CodecLZFast<charType>::utf8_reader::readLiterals(charType* output, const size_t count)
+{
+    for (size_t k = 0; k < count; ++k) {
+        output[k] = CodecUTF8::DecodeCharFromBinaryFile<charType>(inputFile);
+    }
+}
\ No newline at end of file
@@ -5,10 +5,11 @@
 
 #include "../helpers/FileUtils.h"
 #include "../helpers/CodecUTF8.h"
-#include "../helpers/TextUtils.h"
 #include "../helpers/StringL.h"
 #include "../helpers/Array.h"
 
+#include "HistogramUtils.h"
+
 template <typename charType>
 class CodecMTF
 {
@@ -36,6 +37,9 @@ protected:
 
     static data encodeToData(const StringL<charType>& inputStr);
     static void encodeData(std::ofstream& outputFile, const data& data, const bool useUTF8);
+    template <typename consumerType>
+    static Array<charType> encodeCodes(const StringL<charType>& inputStr, consumerType consume);
+    static charType decodeCode(Array<charType>& alphabet, const uint32_t code);
 
     static StringL<charType> decodeData(const data& data);
 };
@@ -43,7 +47,7 @@ protected:
 template <typename charType>
 void CodecMTF<charType>::Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8)
 {
-    Array<charType> alphabet = TextUtils::GetAlphabet<charType>(inputStr);
+    Array<charType> alphabet = HistogramUtils::GetAlphabet(inputStr);
 
     Array<uint32_t> codes(inputStr.size());
     uint32_t index;
@@ -148,18 +152,37 @@ const uint32_t CodecMTF<charType>::GetIndex(const Array<charType>& alphabet, con
 template <typename charType>
 typename CodecMTF<charType>::data CodecMTF<charType>::encodeToData(const StringL<charType>& inputStr)
 {
-    Array<charType> alphabet = TextUtils::GetAlphabet<charType>(inputStr);
-
     Array<uint32_t> codes(inputStr.size());
+    Array<charType> alphabet = encodeCodes(inputStr, [&codes](const uint32_t code) { codes.push_back(code); });
+    return data(alphabet.size(), alphabet, inputStr.size(), codes);
+}
+
+template <typename charType>
+template <typename consumerType>
+Array<charType> CodecMTF<charType>::encodeCodes(const StringL<charType>& inputStr, consumerType consume)
+{
+    Array<charType> alphabet = HistogramUtils::GetAlphabet(inputStr);
+
     uint32_t index;
     for (const auto& c : inputStr) {
         index = GetIndex(alphabet, c);
-        codes.push_back(index);
+        consume(index);
         AlphabetShift(alphabet, index);
     }
 
     std::sort(alphabet.begin(), alphabet.end());
-    return data(alphabet.size(), alphabet, inputStr.size(), codes);
+    return alphabet;
+}
+
+template <typename charType>
+inline charType CodecMTF<charType>::decodeCode(Array<charType>& alphabet, const uint32_t code)
+{
+    if (code >= alphabet.size()) {
+        throw std::runtime_error("CodecMTF error: invalid code");
+    }
+    const charType c = alphabet[code];
+    AlphabetShift(alphabet, code);
+    return c;
 }
 
 template <typename charType>
@@ -2,6 +2,7 @@
 
 #include <string>
 #include <cstdint>
+#include <stdexcept>
 
 #include "../helpers/FileUtils.h"
 #include "../helpers/CodecUTF8.h"
@@ -35,9 +36,34 @@ protected:
         static data fromString(const StringL<charType>& str);
     };
 
+    const static int maxRunLength = 127;
+
+    template <typename consumerType>
+    struct run_encoder {
+        consumerType consume;
+        StringL<charType> uniqueSeq;
+        charType prev;
+        int countIdent;
+        int countUnique;
+        bool flag;
+        bool started;
+
+        explicit run_encoder(consumerType consume_) :
+            consume(consume_), uniqueSeq(maxRunLength), prev(), countIdent(1), countUnique(1), flag(false), started(false) {}
+
+        void push(const charType c);
+        void finish();
+    private:
+        void emitIdent();
+        void emitUnique();
+    };
+
     static data encodeToData(const StringL<charType>& inputStr);
     static void encodeData(std::ofstream& outputFile, const data& data, const bool useUTF8);
     static StringL<charType> decodeData(const data& data);
+    static void appendToken(StringL<charType>& str, const int8_t number, const charType* chars, const size_t count);
+    template <typename consumerType>
+    static void decodeTokens(const StringL<charType>& str, consumerType consume);
 };
 
 template <typename charType>
@@ -335,106 +361,114 @@ typename CodecRLE<charType>::data CodecRLE<charType>::encodeToData(const StringL
     encodedNumbers.resize(inputStr.size()); 
     encodedChars.resize(inputStr.size());
 
-    int countIdent = 1;
-    int countUnique = 1; 
-    StringL<charType> uniqueSeq; 
-    bool flag = false; 
-    int maxPossibleNumber = 127;
-
-    uniqueSeq.resize(maxPossibleNumber);
-    charType prev = inputStr[0];
-    uniqueSeq.push_back(prev);
+    auto consume = [&](const int8_t number, const charType* chars, const size_t count) {
+        encodedNumbers.push_back(number);
+        for (size_t j = 0; j < count; ++j) {
+            encodedChars.push_back(chars[j]);
+        }
+    };
+    run_encoder<decltype(consume)> encoder(consume);
+    for (const auto& c : inputStr) {
+        encoder.push(c);
+    }
+    encoder.finish();
 
-    for (size_t i = 1; i < inputStr.size(); ++i)
-    {
-        if (inputStr[i] == prev) 
-        {
-            if (countUnique > 1) {
-                uniqueSeq.pop_back(); 
-                --countUnique; 
+    return data(inputStr.size(), encodedNumbers, encodedChars);
+}
 
-                encodedNumbers.push_back(-countUnique);
-                for (size_t j = 0; j < uniqueSeq.size(); ++j)
-                    encodedChars.push_back(uniqueSeq[j]);
+template <typename charType>
+template <typename consumerType>
+void CodecRLE<charType>::run_encoder<consumerType>::push(const charType c)
+{
+    if (!started) {
+        prev = c;
+        uniqueSeq.push_back(c);
+        started = true;
+        return;
+    }
 
-                countUnique = 1;
-            }
+    if (c == prev) 
+    {
+        if (countUnique > 1) {
+            uniqueSeq.pop_back(); 
+            --countUnique; 
+            emitUnique();
+            countUnique = 1;
+        }
 
-            if (flag) { countIdent = 1; flag = false; } 
-            else { ++countIdent; }
-            
-            countUnique = 0;
-            uniqueSeq.clear();
+        if (flag) { countIdent = 1; flag = false; } 
+        else { ++countIdent; }
+        
+        countUnique = 0;
+        uniqueSeq.clear();
+    }
+    else 
+    {
+        if (countIdent > 1) {
+            emitIdent();
+            flag = true;
+            countIdent = 1;
+        } else if (countIdent == 0) {
+            countIdent = 1;
         }
-        else 
-        {
-            if (countIdent > 1) {
-                if (countIdent >= maxPossibleNumber) {
-                    for (int i = 0; i < (countIdent / maxPossibleNumber); ++i) {
-                        encodedNumbers.push_back(maxPossibleNumber);
-                        encodedChars.push_back(prev);
-                    }
-                }
-                if (countIdent % maxPossibleNumber != 0) {
-                    encodedNumbers.push_back(countIdent % maxPossibleNumber);
-                    encodedChars.push_back(prev);
-                }
-                flag = true;
-                countIdent = 1;
-            } else if (countIdent == 0) {
-                countIdent = 1;
-            }
 
-            if (flag) {
+        if (flag) {
+            countUnique = 1;
+            uniqueSeq.clear();
+            uniqueSeq.push_back(c);
+            flag = false;
+        } else {
+            if (countUnique == 0) {
                 countUnique = 1;
                 uniqueSeq.clear();
-                uniqueSeq.push_back(inputStr[i]);
-                flag = false;
-            } else {
-                if (countUnique == 0) {
-                    countUnique = 1;
-                    uniqueSeq.clear();
-                    uniqueSeq.push_back(prev);
-                }
-
-                ++countUnique;
-                uniqueSeq.push_back(inputStr[i]);
+                uniqueSeq.push_back(prev);
             }
-            countIdent = 1;
 
-            if (countUnique == maxPossibleNumber) {
-                encodedNumbers.push_back(-countUnique);
-                for (size_t j = 0; j < uniqueSeq.size(); ++j) {
-                    encodedChars.push_back(uniqueSeq[j]);
-                }
-                flag = true;
-                countUnique = 0;
-                uniqueSeq.clear();
-            }
+            ++countUnique;
+            uniqueSeq.push_back(c);
+        }
+        countIdent = 1;
+
+        if (countUnique == maxRunLength) {
+            emitUnique();
+            flag = true;
+            countUnique = 0;
+            uniqueSeq.clear();
         }
-        prev = inputStr[i];
     }
+    prev = c;
+}
 
+template <typename charType>
+template <typename consumerType>
+void CodecRLE<charType>::run_encoder<consumerType>::finish()
+{
+    if (!started) return;
     if (countIdent > 1) {
-        if (countIdent >= maxPossibleNumber) {
-            for (int i = 0; i < (countIdent / maxPossibleNumber); ++i) {
-                encodedNumbers.push_back(maxPossibleNumber);
-                encodedChars.push_back(prev);
-            }
-        }
-        if (countIdent % maxPossibleNumber != 0) {
-            encodedNumbers.push_back(countIdent % maxPossibleNumber);
-            encodedChars.push_back(prev);
-        }
+        emitIdent();
     }
     if (countUnique > 0) {
-        encodedNumbers.push_back(-countUnique);
-        for (size_t j = 0; j < uniqueSeq.size(); ++j) {
-            encodedChars.push_back(uniqueSeq[j]);
-        }
+        emitUnique();
     }
+}
 
-    return data(inputStr.size(), encodedNumbers, encodedChars);
+template <typename charType>
+template <typename consumerType>
+void CodecRLE<charType>::run_encoder<consumerType>::emitIdent()
+{
+    for (int i = 0; i < (countIdent / maxRunLength); ++i) {
+        consume(static_cast<int8_t>(maxRunLength), &prev, 1);
+    }
+    if (countIdent % maxRunLength != 0) {
+        consume(static_cast<int8_t>(countIdent % maxRunLength), &prev, 1);
+    }
+}
+
+template <typename charType>
+template <typename consumerType>
+void CodecRLE<charType>::run_encoder<consumerType>::emitUnique()
+{
+    consume(static_cast<int8_t>(-countUnique), &*uniqueSeq.begin(), uniqueSeq.size());
 }
 
 template <typename charType>
@@ -491,6 +525,39 @@ StringL<charType> CodecRLE<charType>::decodeData(const data& data)
     return decodedStr;
 }
 
+template <typename charType>
+void CodecRLE<charType>::appendToken(StringL<charType>& str, const int8_t number, const charType* chars, const size_t count)
+{
+    str.push_back(static_cast<charType>(number + 128));
+    for (size_t j = 0; j < count; ++j) {
+        str.push_back(chars[j]);
+    }
+}
+
+template <typename charType>
+template <typename consumerType>
+void CodecRLE<charType>::decodeTokens(const StringL<charType>& str, consumerType consume)
+{
+    size_t i = 0;
+    while (i < str.size()) {
+        const int8_t number = static_cast<int8_t>(str[i++] - 128);
+        const size_t count = (number < 0) ? static_cast<size_t>(-number) : 1;
+        if (count > str.size() - i) {
+            throw std::runtime_error("CodecRLE error: invalid token string");
+        }
+
+        if (number < 0) {
+            for (size_t j = 0; j < count; ++j) {
+                consume(str[i++]);
+            }
+        } else {
+            for (int8_t j = 0; j < number; ++j) {
+                consume(str[i]);
+            }
+            ++i;
+        }
+    }
+}
 
 template <typename charType>
 StringL<charType> CodecRLE<charType>::data::toString()
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+#include <thread>
+
+class CodecSettings
+{
+public:
+    enum CMLevel : uint8_t {
+        Normal = 0,
+        Max = 1
+    };
+
+    const static uint8_t minLZ77Level = 1;
+    const static uint8_t maxLZ77Level = 9;
+
+    static CMLevel GetCMLevel() { return cmLevel; }
+    static void SetCMLevel(const CMLevel level) { cmLevel = level; }
+
+    static uint32_t GetACBlockSize() { return acBlockSize; }
+    static void SetACBlockSize(const uint32_t blockSize) { acBlockSize = blockSize; }
+
+    static uint8_t GetLZ77Level() { return lz77Level; }
+    static void SetLZ77Level(const uint8_t level) { lz77Level = std::min(std::max(level, minLZ77Level), maxLZ77Level); }
+
+    static uint32_t GetLZ77ChunkSize() { return lz77ChunkSize; }
+    static void SetLZ77ChunkSize(const uint32_t chunkSize) { lz77ChunkSize = chunkSize; }
+
+    static uint32_t GetLZ77DictionarySize() { return lz77DictionarySize; }
+    static void SetLZ77DictionarySize(const uint32_t dictionarySize) { lz77DictionarySize = dictionarySize; }
+
+    static uint32_t GetLZ77DictionaryId() { return lz77DictionaryId; }
+    static void SetLZ77DictionaryId(const uint32_t id) { lz77DictionaryId = id; }
+
+    static uint32_t GetLZ77LongWindowSize() { return lz77LongWindowSize; }
+    static void SetLZ77LongWindowSize(const uint32_t windowSize) { lz77LongWindowSize = windowSize; }
+
+    static uint32_t GetStreamChunkSize() { return streamChunkSize; }
+    static void SetStreamChunkSize(const uint32_t chunkSize) { streamChunkSize = std::max(chunkSize, 1u); }
+
+    static uint32_t GetContainerBlockSize() { return containerBlockSize; }
+    static void SetContainerBlockSize(const uint32_t blockSize) { containerBlockSize = std::max(blockSize, 1u); }
+
+    static uint32_t GetThreadsCount() { return threadsCount; }
+    static void SetThreadsCount(const uint32_t count) { threadsCount = count; }
+private:
+    CodecSettings() = default;
+
+    inline static CMLevel cmLevel = Normal;
+    inline static uint32_t acBlockSize = 1 << 20;
+    inline static uint8_t lz77Level = 5;
+    inline static uint32_t lz77ChunkSize = 1 << 20;
+    inline static uint32_t lz77DictionarySize = 0;
+    inline static uint32_t lz77DictionaryId = 0;
+    inline static uint32_t lz77LongWindowSize = 0;
+    inline static uint32_t streamChunkSize = 1 << 22;
+    inline static uint32_t containerBlockSize = 1 << 20;
+    inline static uint32_t threadsCount = std::max(1u, std::thread::hardware_concurrency());
+};
\ No newline at end of file
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "Pipeline.h"
+
+template <typename charType>
+class Codec_BWT_MTF_CM: public Pipeline<charType, StageBWT, StageMTF, StageCM>
+{
+private:
+    Codec_BWT_MTF_CM() = default;
+};
\ No newline at end of file
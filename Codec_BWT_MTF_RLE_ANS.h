@@ -0,0 +1,10 @@
+#pragma once
+
+#include "Pipeline.h"
+
+template <typename charType>
+class Codec_BWT_MTF_RLE_ANS: public Pipeline<charType, StageBWT, StageMTFRLE, StageANS>
+{
+private:
+    Codec_BWT_MTF_RLE_ANS() = default;
+};
\ No newline at end of file
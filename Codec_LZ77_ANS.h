@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+
+#include "../helpers/FileUtils.h"
+#include "../helpers/StringL.h"
+#include "../helpers/Array.h"
+
+#include "CodecLZ77.h"
+#include "CodecANS.h"
+
+template <typename charType>
+class Codec_LZ77_ANS: CodecLZ77<charType>, 
+                     CodecANS<charType>
+{
+private:
+    Codec_LZ77_ANS() = default;
+public:
+    static void Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8);
+    static StringL<charType> Decode(std::ifstream& inputFile, const bool useUTF8);
+};
+
+template <typename charType>
+void Codec_LZ77_ANS<charType>::Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8)
+{
+    const auto header = CodecLZ77<charType>::encodeHeader(inputStr);
+    FileUtils::AppendValueBinary(outputFile, header.inputStrLength);
+
+    const uint32_t chunksCount = header.chunksCount();
+    const uint32_t blockChunksCount = header.blockChunksCount();
+    uint32_t chunksEncoded = 0;
+    StringL<charType> strLZ77;
+    header.appendHeaderTo(strLZ77);
+    if (chunksCount < 1) {
+        CodecANS<charType>::encodeData(outputFile, CodecANS<charType>::encodeToData(strLZ77), useUTF8);
+    }
+    CodecLZ77<charType>::encodeChunks(inputStr, header, CodecLZ77<charType>::Coding::Pooled, [&](const typename CodecLZ77<charType>::data& chunk) {
+        chunk.appendTokensTo(strLZ77);
+        if ((++chunksEncoded % blockChunksCount == 0) || (chunksEncoded == chunksCount)) {
+            CodecANS<charType>::encodeData(outputFile, CodecANS<charType>::encodeToData(strLZ77), useUTF8);
+            strLZ77 = StringL<charType>();
+        }
+    });
+    std::cout << "\tLZ77 done." << std::endl;
+    std::cout << "\tANS done." << std::endl;
+}
+
+template <typename charType>
+StringL<charType> Codec_LZ77_ANS<charType>::Decode(std::ifstream& inputFile, const bool useUTF8)
+{
+    uint32_t inputStrLength = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    StringL<charType> strANS = CodecANS<charType>::Decode(inputFile, useUTF8);
+    const auto header = CodecLZ77<charType>::data::fromString(strANS, inputStrLength);
+    strANS.free_memory();
+
+    typename CodecLZ77<charType>::block_decoder decoder(header);
+    decoder.decode(header);
+    while (!decoder.finished()) {
+        strANS = CodecANS<charType>::Decode(inputFile, useUTF8);
+        typename CodecLZ77<charType>::data block;
+        block.chars.resize(strANS.size());
+        block.appendTokensFrom(strANS, 0);
+        strANS.free_memory();
+        decoder.decode(block);
+    }
+    std::cout << "\tANS done." << std::endl;
+    std::cout << "\tLZ77 done." << std::endl;
+
+    return decoder.toString();
+}
\ No newline at end of file
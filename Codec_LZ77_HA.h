@@ -3,63 +3,156 @@
 #include <cstdint>
 
 #include "../helpers/FileUtils.h"
+#include "../helpers/BitArray.h"
 #include "../helpers/StringL.h"
 #include "../helpers/Array.h"
 
 #include "CodecLZ77.h"
 #include "CodecHA.h"
+#include "BitStream.h"
 
 template <typename charType>
-class Codec_LZ77_HA: CodecLZ77<charType>, 
+class Codec_LZ77_HA: CodecLZ77<charType>,
                      CodecHA<charType>
 {
 private:
     Codec_LZ77_HA() = default;
+
+    static void appendValue(StringL<charType>& symbols, BitArray& extraBits, const uint32_t value);
+    static uint32_t readValue(const StringL<charType>& symbols, const size_t index, BitReader& reader);
 public:
     static void Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8);
     static StringL<charType> Decode(std::ifstream& inputFile, const bool useUTF8);
 protected:
-    struct data {
-        uint32_t inputStrLength;
-        typename CodecHA<charType>::data dataHA;
-        data() = default;
+    struct block {
+        uint32_t sequencesCount;
+        StringL<charType> chars;
+        StringL<charType> literalCounts;
+        StringL<charType> lengths;
+        StringL<charType> offsets;
+        BitArray extraBits;
+        block() = default;
     };
+
+    static void encodeBlock(std::ofstream& outputFile, const block& block, const bool useUTF8);
+    static typename CodecLZ77<charType>::data decodeBlock(std::ifstream& inputFile, const bool useUTF8);
 };
 
 template <typename charType>
 void Codec_LZ77_HA<charType>::Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8)
 {
-    Codec_LZ77_HA<charType>::data data;
+    const auto header = CodecLZ77<charType>::encodeHeader(inputStr);
+    FileUtils::AppendValueBinary(outputFile, header.inputStrLength);
+    FileUtils::AppendValueBinary(outputFile, header.chunkSize);
+    FileUtils::AppendValueBinary(outputFile, header.dictionarySize);
+    FileUtils::AppendValueBinary(outputFile, header.dictionaryId);
+    FileUtils::AppendValueBinary(outputFile, header.longWindowSize);
 
-    data.inputStrLength = inputStr.size();
+    const uint32_t chunksCount = header.chunksCount();
+    const uint32_t blockChunksCount = header.blockChunksCount();
+    uint32_t chunksEncoded = 0;
+    block current;
+    current.sequencesCount = 0;
+    CodecLZ77<charType>::encodeChunks(inputStr, header, CodecLZ77<charType>::Coding::Streams, [&](const typename CodecLZ77<charType>::data& chunk) {
+        for (size_t i = 0; i < chunk.literalCounts.size(); ++i) {
+            appendValue(current.literalCounts, current.extraBits, chunk.literalCounts[i]);
+            appendValue(current.lengths, current.extraBits, chunk.lengths[i]);
+            if (chunk.lengths[i] > 0) {
+                appendValue(current.offsets, current.extraBits, chunk.offsets[i] - 1);
+            }
+        }
+        for (const charType& c : chunk.chars) {
+            current.chars.push_back(c);
+        }
+        current.sequencesCount += static_cast<uint32_t>(chunk.literalCounts.size());
 
-    auto lz77Data = CodecLZ77<charType>::encodeToData(inputStr);
-    StringL<charType> strLZ77 = lz77Data.toString();
-    lz77Data.lengths.free_memory();
-    lz77Data.offsets.free_memory();
-    lz77Data.chars.free_memory();
+        if ((++chunksEncoded % blockChunksCount == 0) || (chunksEncoded == chunksCount)) {
+            encodeBlock(outputFile, current, useUTF8);
+            current = block();
+            current.sequencesCount = 0;
+        }
+    });
     std::cout << "\tLZ77 done." << std::endl;
-
-    auto haData = CodecHA<charType>::encodeToData(strLZ77);
-    strLZ77.free_memory();
-    data.dataHA = haData;
     std::cout << "\tHA done." << std::endl;
-
-    CodecHA<charType>::encodeData(outputFile, data.dataHA, useUTF8);
-    FileUtils::AppendValueBinary(outputFile, data.inputStrLength);
 }
 
 template <typename charType>
 StringL<charType> Codec_LZ77_HA<charType>::Decode(std::ifstream& inputFile, const bool useUTF8)
 {
-    StringL<charType> strHA = CodecHA<charType>::Decode(inputFile, useUTF8);
-    std::cout << "\tHA done." << std::endl;
+    typename CodecLZ77<charType>::data header;
+    header.inputStrLength = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    header.chunkSize = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    header.dictionarySize = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    header.dictionaryId = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    header.longWindowSize = FileUtils::ReadValueBinary<uint32_t>(inputFile);
 
-    uint32_t inputStrLength = FileUtils::ReadValueBinary<uint32_t>(inputFile);
-    auto dataLZ77 = CodecLZ77<charType>::data::fromString(strHA, inputStrLength);
-    strHA.free_memory();
-    StringL<charType> decodedStr = CodecLZ77<charType>::decodeData(dataLZ77);
+    typename CodecLZ77<charType>::block_decoder decoder(header);
+    while (!decoder.finished()) {
+        decoder.decode(decodeBlock(inputFile, useUTF8));
+    }
+    std::cout << "\tHA done." << std::endl;
     std::cout << "\tLZ77 done." << std::endl;
 
-    return decodedStr;
+    return decoder.toString();
+}
+
+template <typename charType>
+void Codec_LZ77_HA<charType>::encodeBlock(std::ofstream& outputFile, const block& block, const bool useUTF8)
+{
+    FileUtils::AppendValueBinary(outputFile, block.sequencesCount);
+    CodecHA<charType>::encodeData(outputFile, CodecHA<charType>::encodeToData(block.chars), useUTF8);
+    CodecHA<charType>::encodeData(outputFile, CodecHA<charType>::encodeToData(block.literalCounts), useUTF8);
+    CodecHA<charType>::encodeData(outputFile, CodecHA<charType>::encodeToData(block.lengths), useUTF8);
+    CodecHA<charType>::encodeData(outputFile, CodecHA<charType>::encodeToData(block.offsets), useUTF8);
+    BitArray::to_file(outputFile, block.extraBits);
+}
+
+template <typename charType>
+typename CodecLZ77<charType>::data Codec_LZ77_HA<charType>::decodeBlock(std::ifstream& inputFile, const bool useUTF8)
+{
+    uint32_t sequencesCount = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+
+    typename CodecLZ77<charType>::data dataLZ77;
+    dataLZ77.chars = CodecHA<charType>::Decode(inputFile, useUTF8);
+    StringL<charType> literalCounts = CodecHA<charType>::Decode(inputFile, useUTF8);
+    StringL<charType> lengths = CodecHA<charType>::Decode(inputFile, useUTF8);
+    StringL<charType> offsets = CodecHA<charType>::Decode(inputFile, useUTF8);
+
+    if ((literalCounts.size() != sequencesCount) || (lengths.size() != sequencesCount) || (offsets.size() > sequencesCount)) {
+        throw std::runtime_error("Codec_LZ77_HA error: stream sizes do not match");
+    }
+
+    BitReader reader(inputFile);
+    size_t matchesCount = 0;
+    for (size_t i = 0; i < sequencesCount; ++i) {
+        dataLZ77.literalCounts.push_back(readValue(literalCounts, i, reader));
+        dataLZ77.lengths.push_back(readValue(lengths, i, reader));
+        if (dataLZ77.lengths[i] == 0) {
+            dataLZ77.offsets.push_back(0);
+        } else if (matchesCount < offsets.size()) {
+            dataLZ77.offsets.push_back(readValue(offsets, matchesCount++, reader) + 1);
+        } else {
+            throw std::runtime_error("Codec_LZ77_HA error: stream sizes do not match");
+        }
+    }
+
+    return dataLZ77;
+}
+
+template <typename charType>
+void Codec_LZ77_HA<charType>::appendValue(StringL<charType>& symbols, BitArray& extraBits, const uint32_t value)
+{
+    const uint32_t bucket = CodecLZ77<charType>::valueBucket(value);
+    symbols.push_back(static_cast<charType>(bucket));
+    BitStream::AppendBits(extraBits, value - CodecLZ77<charType>::bucketBase(bucket), CodecLZ77<charType>::bucketExtraBits(bucket));
+}
+
+template <typename charType>
+uint32_t Codec_LZ77_HA<charType>::readValue(const StringL<charType>& symbols, const size_t index, BitReader& reader)
+{
+    const uint32_t bucket = static_cast<std::make_unsigned_t<charType>>(symbols[index]);
+    if (bucket >= CodecLZ77<charType>::bucketsCount) {
+        throw std::runtime_error("Codec_LZ77_HA error: invalid value bucket");
+    }
+    return CodecLZ77<charType>::bucketBase(bucket) + static_cast<uint32_t>(reader.ReadBits(CodecLZ77<charType>::bucketExtraBits(bucket)));
 }
\ No newline at end of file
@@ -0,0 +1,322 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <functional>
+#include <istream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../helpers/FileUtils.h"
+#include "../helpers/StringL.h"
+
+#include "CodecSettings.h"
+#include "CRC32C.h"
+#include "StreamUtils.h"
+
+template <typename charType> class CodecHA;
+template <typename charType> class CodecAC;
+template <typename charType> class CodecANS;
+template <typename charType> class CodecCM;
+template <typename charType> class CodecBWT;
+template <typename charType> class CodecMTF;
+template <typename charType> class CodecRLE;
+template <typename charType> class CodecLZ77;
+template <typename charType> class CodecLZFast;
+template <typename charType> class Codec_LZ77_HA;
+template <typename charType> class Codec_LZ77_ANS;
+template <typename charType> class Codec_BWT_MTF_AC;
+template <typename charType> class Codec_BWT_MTF_CM;
+template <typename charType> class Codec_BWT_MTF_HA;
+template <typename charType> class Codec_BWT_MTF_RLE_AC;
+template <typename charType> class Codec_BWT_MTF_RLE_ANS;
+template <typename charType> class Codec_BWT_MTF_RLE_HA;
+template <typename charType> class Codec_BWT_RLE;
+template <typename charType> class Codec_RLE_HA;
+
+template <template <typename> class codecType> struct ContainerCodecId;
+template <> struct ContainerCodecId<CodecHA> { const static uint8_t value = 1; };
+template <> struct ContainerCodecId<CodecAC> { const static uint8_t value = 2; };
+template <> struct ContainerCodecId<CodecANS> { const static uint8_t value = 3; };
+template <> struct ContainerCodecId<CodecCM> { const static uint8_t value = 4; };
+template <> struct ContainerCodecId<CodecBWT> { const static uint8_t value = 5; };
+template <> struct ContainerCodecId<CodecMTF> { const static uint8_t value = 6; };
+template <> struct ContainerCodecId<CodecRLE> { const static uint8_t value = 7; };
+template <> struct ContainerCodecId<CodecLZ77> { const static uint8_t value = 8; };
+template <> struct ContainerCodecId<CodecLZFast> { const static uint8_t value = 9; };
+template <> struct ContainerCodecId<Codec_LZ77_HA> { const static uint8_t value = 10; };
+template <> struct ContainerCodecId<Codec_LZ77_ANS> { const static uint8_t value = 11; };
+template <> struct ContainerCodecId<Codec_BWT_MTF_AC> { const static uint8_t value = 12; };
+template <> struct ContainerCodecId<Codec_BWT_MTF_CM> { const static uint8_t value = 13; };
+template <> struct ContainerCodecId<Codec_BWT_MTF_HA> { const static uint8_t value = 14; };
+template <> struct ContainerCodecId<Codec_BWT_MTF_RLE_AC> { const static uint8_t value = 15; };
+template <> struct ContainerCodecId<Codec_BWT_MTF_RLE_ANS> { const static uint8_t value = 16; };
+template <> struct ContainerCodecId<Codec_BWT_MTF_RLE_HA> { const static uint8_t value = 17; };
+template <> struct ContainerCodecId<Codec_BWT_RLE> { const static uint8_t value = 18; };
+template <> struct ContainerCodecId<Codec_RLE_HA> { const static uint8_t value = 19; };
+
+template <typename charType, template <typename> class codecType>
+class Container
+{
+public:
+    static void Encode(const std::function<size_t(charType*, size_t)>& source, std::ofstream& outputFile, const bool useUTF8);
+    static void Encode(std::istream& input, std::ofstream& outputFile, const bool useUTF8);
+    static void Decode(std::ifstream& inputFile, const std::function<void(const charType*, size_t)>& sink);
+    static void Decode(std::ifstream& inputFile, std::ostream& output);
+    static StringL<charType> DecodeRange(std::ifstream& inputFile, const uint64_t position, const uint64_t length);
+    static uint64_t GetLength(std::ifstream& inputFile);
+private:
+    Container() = default;
+
+    using codec = codecType<charType>;
+
+    const static uint32_t magic = 0x31424B43;
+    const static uint8_t version = 1;
+    const static uint8_t utf8Flag = 1;
+    const static size_t entrySize = sizeof(uint64_t) + 4 * sizeof(uint32_t);
+    const static size_t trailerSize = sizeof(uint64_t) + 3 * sizeof(uint32_t);
+
+    struct block_entry {
+        uint64_t offset;
+        uint64_t first;
+        uint32_t payloadLength;
+        uint32_t symbolsCount;
+        uint32_t checksum;
+        uint32_t payloadChecksum;
+    };
+
+    struct archive {
+        std::streampos start;
+        std::streampos end;
+        bool useUTF8;
+        uint64_t length;
+        std::vector<block_entry> blocks;
+    };
+
+    static archive readArchive(std::ifstream& inputFile);
+    static StringL<charType> decodeBlock(std::ifstream& inputFile, const archive& archive, const block_entry& block);
+
+    template <typename T>
+    static void appendValue(std::vector<uint8_t>& bytes, const T value);
+    template <typename T>
+    static T readValue(const std::vector<uint8_t>& bytes, size_t& position);
+};
+
+template <typename charType, template <typename> class codecType>
+void Container<charType, codecType>::Encode(const std::function<size_t(charType*, size_t)>& source, std::ofstream& outputFile, const bool useUTF8)
+{
+    const std::streampos start = outputFile.tellp();
+    FileUtils::AppendValueBinary(outputFile, uint32_t(magic));
+    FileUtils::AppendValueBinary(outputFile, uint8_t(version));
+    FileUtils::AppendValueBinary(outputFile, uint8_t(ContainerCodecId<codecType>::value));
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint8_t>(sizeof(charType)));
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint8_t>(useUTF8 ? utf8Flag : 0));
+
+    std::vector<uint8_t> index;
+    uint32_t blocksCount = 0;
+    std::vector<charType> buffer(CodecSettings::GetContainerBlockSize());
+    size_t count;
+    do {
+        count = StreamUtils::ReadChunk(source, buffer);
+        if (count < 1) break;
+
+        StringL<charType> block(count);
+        for (size_t i = 0; i < count; ++i) {
+            block.push_back(buffer[i]);
+        }
+
+        const std::string payload = StreamUtils::CaptureOutput([&](std::ofstream& output) { codec::Encode(block, output, useUTF8); });
+        block.free_memory();
+
+        appendValue(index, static_cast<uint64_t>(outputFile.tellp() - start));
+        outputFile.write(payload.data(), payload.size());
+        appendValue(index, static_cast<uint32_t>(payload.size()));
+        appendValue(index, static_cast<uint32_t>(count));
+        appendValue(index, CRC32C::Compute(buffer.data(), count * sizeof(charType)));
+        appendValue(index, CRC32C::Compute(payload.data(), payload.size()));
+        ++blocksCount;
+    } while (count == buffer.size());
+
+    const uint64_t indexOffset = static_cast<uint64_t>(outputFile.tellp() - start);
+    outputFile.write(reinterpret_cast<const char*>(index.data()), index.size());
+    FileUtils::AppendValueBinary(outputFile, indexOffset);
+    FileUtils::AppendValueBinary(outputFile, blocksCount);
+    FileUtils::AppendValueBinary(outputFile, CRC32C::Compute(index.data(), index.size()));
+    FileUtils::AppendValueBinary(outputFile, uint32_t(magic));
+}
+
+template <typename charType, template <typename> class codecType>
+void Container<charType, codecType>::Encode(std::istream& input, std::ofstream& outputFile, const bool useUTF8)
+{
+    Encode(StreamUtils::SourceFrom<charType>(input), outputFile, useUTF8);
+}
+
+template <typename charType, template <typename> class codecType>
+void Container<charType, codecType>::Decode(std::ifstream& inputFile, const std::function<void(const charType*, size_t)>& sink)
+{
+    const archive archive = readArchive(inputFile);
+    for (const block_entry& block : archive.blocks) {
+        StringL<charType> symbols = decodeBlock(inputFile, archive, block);
+        sink(&*symbols.begin(), symbols.size());
+    }
+    inputFile.seekg(archive.end);
+}
+
+template <typename charType, template <typename> class codecType>
+void Container<charType, codecType>::Decode(std::ifstream& inputFile, std::ostream& output)
+{
+    Decode(inputFile, [&output](const charType* symbols, const size_t count) {
+        output.write(reinterpret_cast<const char*>(symbols), count * sizeof(charType));
+    });
+}
+
+template <typename charType, template <typename> class codecType>
+StringL<charType> Container<charType, codecType>::DecodeRange(std::ifstream& inputFile, const uint64_t position, const uint64_t length)
+{
+    const archive archive = readArchive(inputFile);
+    if ((position > archive.length) || (length > archive.length - position)) {
+        throw std::runtime_error("Container error: range is out of bounds");
+    }
+
+    StringL<charType> result(length);
+    const uint64_t end = position + length;
+    auto block = std::upper_bound(archive.blocks.begin(), archive.blocks.end(), position,
+        [](const uint64_t value, const block_entry& entry) { return value < entry.first; });
+    if (block != archive.blocks.begin()) --block;
+
+    for (; (block != archive.blocks.end()) && (block->first < end); ++block) {
+        const StringL<charType> symbols = decodeBlock(inputFile, archive, *block);
+        const uint64_t from = std::max(position, block->first) - block->first;
+        const uint64_t to = std::min<uint64_t>(end, block->first + block->symbolsCount) - block->first;
+        for (uint64_t i = from; i < to; ++i) {
+            result.push_back(symbols[i]);
+        }
+    }
+    inputFile.seekg(archive.end);
+    return result;
+}
+
+template <typename charType, template <typename> class codecType>
+uint64_t Container<charType, codecType>::GetLength(std::ifstream& inputFile)
+{
+    const archive archive = readArchive(inputFile);
+    inputFile.seekg(archive.end);
+    return archive.length;
+}
+
+template <typename charType, template <typename> class codecType>
+typename Container<charType, codecType>::archive Container<charType, codecType>::readArchive(std::ifstream& inputFile)
+{
+    archive archive;
+    archive.start = inputFile.tellg();
+    if (FileUtils::ReadValueBinary<uint32_t>(inputFile) != magic) {
+        throw std::runtime_error("Container error: not a container");
+    }
+    if (FileUtils::ReadValueBinary<uint8_t>(inputFile) != version) {
+        throw std::runtime_error("Container error: unsupported version");
+    }
+    if (FileUtils::ReadValueBinary<uint8_t>(inputFile) != ContainerCodecId<codecType>::value) {
+        throw std::runtime_error("Container error: container was written by another codec");
+    }
+    if (FileUtils::ReadValueBinary<uint8_t>(inputFile) != sizeof(charType)) {
+        throw std::runtime_error("Container error: symbol size does not match");
+    }
+    archive.useUTF8 = (FileUtils::ReadValueBinary<uint8_t>(inputFile) & utf8Flag) != 0;
+    const uint64_t headerSize = static_cast<uint64_t>(inputFile.tellg() - archive.start);
+
+    inputFile.seekg(0, std::ios::end);
+    archive.end = inputFile.tellg();
+    const uint64_t size = static_cast<uint64_t>(archive.end - archive.start);
+    if (size < headerSize + trailerSize) {
+        throw std::runtime_error("Container error: unexpected end of file");
+    }
+    inputFile.seekg(archive.end - std::streamoff(trailerSize));
+    const uint64_t indexOffset = FileUtils::ReadValueBinary<uint64_t>(inputFile);
+    const uint32_t blocksCount = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    const uint32_t indexChecksum = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    if (FileUtils::ReadValueBinary<uint32_t>(inputFile) != magic) {
+        throw std::runtime_error("Container error: missing index trailer");
+    }
+    if ((indexOffset < headerSize) || (indexOffset > size - trailerSize) || ((size - trailerSize - indexOffset) != uint64_t(blocksCount) * entrySize)) {
+        throw std::runtime_error("Container error: corrupted index");
+    }
+
+    std::vector<uint8_t> index(blocksCount * entrySize);
+    inputFile.seekg(archive.start + std::streamoff(indexOffset));
+    inputFile.read(reinterpret_cast<char*>(index.data()), index.size());
+    if (static_cast<size_t>(inputFile.gcount()) != index.size()) {
+        throw std::runtime_error("Container error: unexpected end of file");
+    }
+    if (CRC32C::Compute(index.data(), index.size()) != indexChecksum) {
+        throw std::runtime_error("Container error: index checksum mismatch");
+    }
+
+    archive.length = 0;
+    archive.blocks.reserve(blocksCount);
+    size_t position = 0;
+    for (uint32_t i = 0; i < blocksCount; ++i) {
+        block_entry block;
+        block.offset = readValue<uint64_t>(index, position);
+        block.payloadLength = readValue<uint32_t>(index, position);
+        block.symbolsCount = readValue<uint32_t>(index, position);
+        block.checksum = readValue<uint32_t>(index, position);
+        block.payloadChecksum = readValue<uint32_t>(index, position);
+        block.first = archive.length;
+        if ((block.offset < headerSize) || (block.offset > indexOffset) || (block.payloadLength > indexOffset - block.offset)) {
+            throw std::runtime_error("Container error: corrupted index");
+        }
+        archive.length += block.symbolsCount;
+        archive.blocks.push_back(block);
+    }
+    return archive;
+}
+
+template <typename charType, template <typename> class codecType>
+StringL<charType> Container<charType, codecType>::decodeBlock(std::ifstream& inputFile, const archive& archive, const block_entry& block)
+{
+    const std::streampos blockStart = archive.start + std::streamoff(block.offset);
+    inputFile.seekg(blockStart);
+    std::vector<char> payload(block.payloadLength);
+    inputFile.read(payload.data(), payload.size());
+    if (static_cast<size_t>(inputFile.gcount()) != payload.size()) {
+        throw std::runtime_error("Container error: unexpected end of file");
+    }
+    if (CRC32C::Compute(payload.data(), payload.size()) != block.payloadChecksum) {
+        throw std::runtime_error("Container error: block payload checksum mismatch");
+    }
+    payload = std::vector<char>();
+
+    inputFile.seekg(blockStart);
+    StringL<charType> symbols = codec::Decode(inputFile, archive.useUTF8);
+    if (inputFile.tellg() - blockStart > std::streamoff(block.payloadLength)) {
+        throw std::runtime_error("Container error: block exceeds its index entry");
+    }
+    if (symbols.size() != block.symbolsCount) {
+        throw std::runtime_error("Container error: block length does not match the index");
+    }
+    if ((block.symbolsCount > 0) && (CRC32C::Compute(&*symbols.begin(), symbols.size() * sizeof(charType)) != block.checksum)) {
+        throw std::runtime_error("Container error: block checksum mismatch");
+    }
+    return symbols;
+}
+
+template <typename charType, template <typename> class codecType>
+template <typename T>
+void Container<charType, codecType>::appendValue(std::vector<uint8_t>& bytes, const T value)
+{
+    const uint8_t* begin = reinterpret_cast<const uint8_t*>(&value);
+    bytes.insert(bytes.end(), begin, begin + sizeof(T));
+}
+
+template <typename charType, template <typename> class codecType>
+template <typename T>
+T Container<charType, codecType>::readValue(const std::vector<uint8_t>& bytes, size_t& position)
+{
+    T value;
+    std::memcpy(&value, bytes.data() + position, sizeof(T));
+    position += sizeof(T);
+    return value;
+}
\ No newline at end of file
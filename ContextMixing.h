@@ -0,0 +1,173 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+class Logistic
+{
+public:
+    const static int probabilityBits = 12;
+    const static int maxStretch = 2047;
+
+    static int Stretch(const uint32_t probability) { return stretchTable()[probability]; }
+    static uint32_t Squash(const int value);
+private:
+    Logistic() = default;
+
+    static const std::vector<int16_t>& stretchTable();
+};
+
+class ProbabilityMap
+{
+public:
+    ProbabilityMap(const size_t contextsCount, const uint32_t limit);
+
+    uint32_t Predict(const size_t context) { index = context; return table[index] >> 20; }
+    void Update(const int bit);
+private:
+    std::vector<uint32_t> table;
+    size_t index;
+    uint32_t limit;
+
+    static const std::vector<int32_t>& reciprocals();
+};
+
+class Mixer
+{
+public:
+    Mixer(const uint32_t inputsCount, const uint32_t contextsCount, const int learningRate);
+
+    void Add(const int input) { inputs[count++] = input; }
+    void SetContext(const uint32_t _context) { context = _context; }
+    uint32_t Mix();
+    void Update(const int bit);
+private:
+    uint32_t inputsCount;
+    uint32_t count;
+    uint32_t context;
+    uint32_t probability;
+    int learningRate;
+    std::vector<int> inputs;
+    std::vector<int32_t> weights;
+};
+
+class APM
+{
+public:
+    APM(const uint32_t contextsCount, const int rate);
+
+    uint32_t Refine(const uint32_t probability, const uint32_t context);
+    void Update(const int bit);
+private:
+    const static uint32_t binsCount = 33;
+
+    std::vector<uint16_t> table;
+    size_t index;
+    int rate;
+};
+
+inline uint32_t Logistic::Squash(const int value)
+{
+    static const int points[33] = {
+        1, 2, 3, 6, 10, 16, 27, 45, 73, 120, 194, 310, 488, 747, 1101, 1546,
+        2047, 2549, 2994, 3348, 3607, 3785, 3901, 3975, 4022, 4050, 4068, 4079, 4085, 4089, 4092, 4093, 4094
+    };
+    if (value > maxStretch) return 4095;
+    if (value < -maxStretch) return 1;
+    const int weight = value & 127;
+    const int point = (value >> 7) + 16;
+    return static_cast<uint32_t>((points[point] * (128 - weight) + points[point + 1] * weight + 64) >> 7);
+}
+
+inline const std::vector<int16_t>& Logistic::stretchTable()
+{
+    static const std::vector<int16_t> table = [] {
+        std::vector<int16_t> result(1 << probabilityBits, maxStretch);
+        uint32_t next = 0;
+        for (int x = -maxStretch; x <= maxStretch; ++x) {
+            const uint32_t value = Squash(x);
+            for (uint32_t p = next; p <= value; ++p) {
+                result[p] = static_cast<int16_t>(x);
+            }
+            next = value + 1;
+        }
+        return result;
+    }();
+    return table;
+}
+
+inline ProbabilityMap::ProbabilityMap(const size_t contextsCount, const uint32_t limit) :
+    table(contextsCount, uint32_t(1) << 31), index(0), limit(limit) {}
+
+inline void ProbabilityMap::Update(const int bit)
+{
+    uint32_t& entry = table[index];
+    const uint32_t count = entry & 1023;
+    const int64_t probability = entry >> 10;
+    if (count < limit) ++entry;
+    else entry = (entry & 0xFFFFFC00) | limit;
+
+    const int64_t delta = (((int64_t(bit) << 22) - probability) >> 3) * reciprocals()[count];
+    entry += static_cast<uint32_t>(delta) & 0xFFFFFC00;
+}
+
+inline const std::vector<int32_t>& ProbabilityMap::reciprocals()
+{
+    static const std::vector<int32_t> table = [] {
+        std::vector<int32_t> result(1024);
+        for (int32_t i = 0; i < 1024; ++i) {
+            result[i] = 16384 / (i + i + 3);
+        }
+        return result;
+    }();
+    return table;
+}
+
+inline Mixer::Mixer(const uint32_t inputsCount, const uint32_t contextsCount, const int learningRate) :
+    inputsCount(inputsCount), count(0), context(0), probability(2048), learningRate(learningRate),
+    inputs(inputsCount, 0), weights(size_t(inputsCount) * contextsCount, (1 << 16) / inputsCount) {}
+
+inline uint32_t Mixer::Mix()
+{
+    const int32_t* weight = &weights[size_t(context) * inputsCount];
+    int64_t dot = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        dot += int64_t(inputs[i]) * weight[i];
+    }
+    probability = Logistic::Squash(static_cast<int>(dot >> 16));
+    return probability;
+}
+
+inline void Mixer::Update(const int bit)
+{
+    int32_t* weight = &weights[size_t(context) * inputsCount];
+    const int error = ((bit << Logistic::probabilityBits) - static_cast<int>(probability)) * learningRate;
+    for (uint32_t i = 0; i < count; ++i) {
+        weight[i] += (inputs[i] * error) >> 10;
+    }
+    count = 0;
+}
+
+inline APM::APM(const uint32_t contextsCount, const int rate) : table(size_t(contextsCount) * binsCount), index(0), rate(rate)
+{
+    for (size_t i = 0; i < table.size(); ++i) {
+        const int bin = static_cast<int>(i % binsCount);
+        table[i] = static_cast<uint16_t>(Logistic::Squash((bin - 16) * 128) * 16);
+    }
+}
+
+inline uint32_t APM::Refine(const uint32_t probability, const uint32_t context)
+{
+    const int stretched = Logistic::Stretch(probability) + Logistic::maxStretch + 1;
+    const int weight = stretched & 127;
+    const size_t base = size_t(context) * binsCount + (stretched >> 7);
+    index = base + (weight >> 6);
+    return (table[base] * uint32_t(128 - weight) + table[base + 1] * uint32_t(weight)) >> 11;
+}
+
+inline void APM::Update(const int bit)
+{
+    const int target = (bit << 16) + (bit << rate) - bit - bit;
+    table[index] = static_cast<uint16_t>(table[index] + ((target - table[index]) >> rate));
+}
\ No newline at end of file
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+#include <utility>
+#include <type_traits>
+#include <stdexcept>
+
+#include "../helpers/StringL.h"
+#include "../helpers/Array.h"
+
+class HistogramUtils
+{
+public:
+    template <typename charType>
+    static void Build(const StringL<charType>& str, Array<charType>& alphabet, Array<uint32_t>& frequencies);
+    template <typename charType>
+    static void Build(const StringL<charType>& str, const size_t begin, const size_t end, Array<charType>& alphabet, Array<uint32_t>& frequencies);
+    template <typename charType>
+    static Array<charType> GetAlphabet(const StringL<charType>& str);
+    template <typename charType>
+    static void Merge(const Array<charType>& alphabetA, const Array<uint32_t>& frequenciesA, 
+        const Array<charType>& alphabetB, const Array<uint32_t>& frequenciesB, 
+        Array<charType>& alphabet, Array<uint32_t>& frequencies);
+    static Array<uint32_t> Normalize(const Array<uint32_t>& frequencies, const uint32_t totalBits);
+private:
+    HistogramUtils() = default;
+
+    static const size_t interleavedTablesCount = 4;
+    static const size_t denseTableMinLength = 1 << 14;
+
+    template <typename charType>
+    static void buildInterleaved(const charType* symbols, const size_t length, Array<charType>& alphabet, Array<uint32_t>& frequencies);
+    template <typename charType>
+    static void buildDense(const charType* symbols, const size_t length, Array<charType>& alphabet, Array<uint32_t>& frequencies);
+    template <typename charType>
+    static void buildHashed(const charType* symbols, const size_t length, Array<charType>& alphabet, Array<uint32_t>& frequencies);
+};
+
+template <typename charType>
+void HistogramUtils::Build(const StringL<charType>& str, Array<charType>& alphabet, Array<uint32_t>& frequencies)
+{
+    Build(str, 0, str.size(), alphabet, frequencies);
+}
+
+template <typename charType>
+void HistogramUtils::Build(const StringL<charType>& str, const size_t begin, const size_t end, Array<charType>& alphabet, Array<uint32_t>& frequencies)
+{
+    alphabet.clear();
+    frequencies.clear();
+    if (begin >= end) return;
+
+    const charType* symbols = &*str.begin() + begin;
+    const size_t length = end - begin;
+
+    if constexpr (sizeof(charType) == 1) {
+        buildInterleaved(symbols, length, alphabet, frequencies);
+    } else if constexpr (sizeof(charType) == 2) {
+        if (length >= denseTableMinLength) {
+            buildDense(symbols, length, alphabet, frequencies);
+        } else {
+            buildHashed(symbols, length, alphabet, frequencies);
+        }
+    } else {
+        buildHashed(symbols, length, alphabet, frequencies);
+    }
+}
+
+template <typename charType>
+Array<charType> HistogramUtils::GetAlphabet(const StringL<charType>& str)
+{
+    Array<charType> alphabet;
+    Array<uint32_t> frequencies;
+    Build(str, alphabet, frequencies);
+    return alphabet;
+}
+
+template <typename charType>
+void HistogramUtils::Merge(const Array<charType>& alphabetA, const Array<uint32_t>& frequenciesA, 
+    const Array<charType>& alphabetB, const Array<uint32_t>& frequenciesB, 
+    Array<charType>& alphabet, Array<uint32_t>& frequencies)
+{
+    alphabet.clear();
+    frequencies.clear();
+    alphabet.resize(alphabetA.size() + alphabetB.size());
+    frequencies.resize(alphabetA.size() + alphabetB.size());
+
+    size_t i = 0, j = 0;
+    while ((i < alphabetA.size()) || (j < alphabetB.size())) {
+        if ((j == alphabetB.size()) || ((i < alphabetA.size()) && (alphabetA[i] < alphabetB[j]))) {
+            alphabet.push_back(alphabetA[i]);
+            frequencies.push_back(frequenciesA[i++]);
+        } else if ((i == alphabetA.size()) || (alphabetB[j] < alphabetA[i])) {
+            alphabet.push_back(alphabetB[j]);
+            frequencies.push_back(frequenciesB[j++]);
+        } else {
+            alphabet.push_back(alphabetA[i]);
+            frequencies.push_back(frequenciesA[i++] + frequenciesB[j++]);
+        }
+    }
+}
+
+inline Array<uint32_t> HistogramUtils::Normalize(const Array<uint32_t>& frequencies, const uint32_t totalBits)
+{
+    if (frequencies.size() < 1) return Array<uint32_t>();
+
+    const uint64_t totalFrequency = uint64_t(1) << totalBits;
+    if (frequencies.size() > totalFrequency) {
+        throw std::runtime_error("HistogramUtils error: too many symbols to normalize");
+    }
+
+    uint64_t strLength = 0;
+    for (const uint32_t& frequency : frequencies) {
+        strLength += frequency;
+    }
+
+    Array<uint32_t> normalized(frequencies.size());
+    int64_t difference = static_cast<int64_t>(totalFrequency);
+    for (const uint32_t& frequency : frequencies) {
+        uint32_t scaled = static_cast<uint32_t>(std::max<uint64_t>(1, frequency * totalFrequency / strLength));
+        normalized.push_back(scaled);
+        difference -= scaled;
+    }
+
+    Array<uint32_t> order(frequencies.size());
+    for (uint32_t i = 0; i < frequencies.size(); ++i) {
+        order.push_back(i);
+    }
+    std::stable_sort(order.begin(), order.end(),
+        [&normalized](const uint32_t a, const uint32_t b) { return normalized[a] > normalized[b]; });
+
+    for (size_t i = 0; difference != 0; i = (i + 1) % order.size()) {
+        const uint32_t symbol = order[i];
+        if (difference > 0) {
+            normalized.assign(symbol, normalized[symbol] + static_cast<uint32_t>(difference));
+            difference = 0;
+        } else if (normalized[symbol] > 1) {
+            const uint32_t decrease = static_cast<uint32_t>(std::min<int64_t>(-difference, normalized[symbol] - 1));
+            normalized.assign(symbol, normalized[symbol] - decrease);
+            difference += decrease;
+        }
+    }
+
+    return normalized;
+}
+
+template <typename charType>
+void HistogramUtils::buildInterleaved(const charType* symbols, const size_t length, Array<charType>& alphabet, Array<uint32_t>& frequencies)
+{
+    uint32_t counts[interleavedTablesCount][256] = {};
+
+    size_t i = 0;
+    for (; i + interleavedTablesCount <= length; i += interleavedTablesCount) {
+        ++counts[0][static_cast<uint8_t>(symbols[i])];
+        ++counts[1][static_cast<uint8_t>(symbols[i + 1])];
+        ++counts[2][static_cast<uint8_t>(symbols[i + 2])];
+        ++counts[3][static_cast<uint8_t>(symbols[i + 3])];
+    }
+    for (; i < length; ++i) {
+        ++counts[0][static_cast<uint8_t>(symbols[i])];
+    }
+
+    for (uint32_t i = 0; i < 256; ++i) {
+        const uint32_t c = std::is_signed_v<charType> ? ((i + 128) & 0xFF) : i;
+        uint32_t total = counts[0][c] + counts[1][c] + counts[2][c] + counts[3][c];
+        if (total > 0) {
+            alphabet.push_back(static_cast<charType>(c));
+            frequencies.push_back(total);
+        }
+    }
+}
+
+template <typename charType>
+void HistogramUtils::buildDense(const charType* symbols, const size_t length, Array<charType>& alphabet, Array<uint32_t>& frequencies)
+{
+    std::vector<uint32_t> counts(1 << 16, 0);
+    for (size_t i = 0; i < length; ++i) {
+        ++counts[static_cast<uint16_t>(symbols[i])];
+    }
+
+    for (uint32_t i = 0; i < counts.size(); ++i) {
+        const uint32_t c = std::is_signed_v<charType> ? ((i + 0x8000) & 0xFFFF) : i;
+        if (counts[c] > 0) {
+            alphabet.push_back(static_cast<charType>(c));
+            frequencies.push_back(counts[c]);
+        }
+    }
+}
+
+template <typename charType>
+void HistogramUtils::buildHashed(const charType* symbols, const size_t length, Array<charType>& alphabet, Array<uint32_t>& frequencies)
+{
+    size_t capacityLog = 8;
+    std::vector<std::pair<charType, uint32_t>> table(size_t(1) << capacityLog, { charType(), 0 });
+    size_t distinctCount = 0;
+
+    auto slotOf = [](const charType c, const size_t capacityLog) {
+        return static_cast<size_t>((static_cast<uint64_t>(c) * 0x9E3779B97F4A7C15ull) >> (64 - capacityLog));
+    };
+
+    for (size_t i = 0; i < length; ++i) {
+        const size_t mask = table.size() - 1;
+        size_t slot = slotOf(symbols[i], capacityLog);
+        while (table[slot].second != 0 && table[slot].first != symbols[i]) {
+            slot = (slot + 1) & mask;
+        }
+        if (table[slot].second++ != 0) continue;
+
+        table[slot].first = symbols[i];
+        if (++distinctCount * 2 > table.size()) {
+            std::vector<std::pair<charType, uint32_t>> oldTable(size_t(1) << ++capacityLog, { charType(), 0 });
+            oldTable.swap(table);
+            for (const auto& entry : oldTable) {
+                if (entry.second == 0) continue;
+                size_t newSlot = slotOf(entry.first, capacityLog);
+                while (table[newSlot].second != 0) {
+                    newSlot = (newSlot + 1) & (table.size() - 1);
+                }
+                table[newSlot] = entry;
+            }
+        }
+    }
+
+    std::vector<std::pair<charType, uint32_t>> entries;
+    entries.reserve(distinctCount);
+    for (const auto& entry : table) {
+        if (entry.second != 0) entries.push_back(entry);
+    }
+    std::sort(entries.begin(), entries.end());
+
+    alphabet.resize(entries.size());
+    frequencies.resize(entries.size());
+    for (const auto& entry : entries) {
+        alphabet.push_back(entry.first);
+        frequencies.push_back(entry.second);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <type_traits>
+#include <stdexcept>
+
+#include "../helpers/StringL.h"
+
+template <typename charType>
+class LZ77Dictionary
+{
+public:
+    static StringL<charType> Train(const std::vector<StringL<charType>>& samples, const uint32_t dictionarySize);
+
+    static uint32_t Register(const StringL<charType>& dictionary);
+    static const StringL<charType>& Get(const uint32_t id);
+private:
+    LZ77Dictionary() = default;
+
+    const static uint32_t dmerLength = 8;
+    const static uint32_t segmentLength = 64;
+
+    struct segment {
+        size_t begin;
+        uint64_t score;
+    };
+
+    static uint32_t computeId(const StringL<charType>& dictionary);
+    static segment findSegment(const std::vector<uint64_t>& dmers, const std::unordered_map<uint64_t, uint32_t>& frequencies,
+        const size_t begin, const size_t end);
+
+    inline static std::unordered_map<uint32_t, StringL<charType>> dictionaries;
+    inline static std::mutex mutex;
+};
+
+template <typename charType>
+StringL<charType> LZ77Dictionary<charType>::Train(const std::vector<StringL<charType>>& samples, const uint32_t dictionarySize)
+{
+    const uint64_t invalidDmer = UINT64_MAX;
+
+    std::vector<charType> corpus;
+    std::vector<uint64_t> dmers;
+    std::unordered_map<uint64_t, uint32_t> frequencies;
+    for (const StringL<charType>& sample : samples) {
+        const size_t sampleBegin = corpus.size();
+        corpus.insert(corpus.end(), sample.begin(), sample.end());
+
+        std::unordered_map<uint64_t, bool> seen;
+        for (size_t i = sampleBegin; i < corpus.size(); ++i) {
+            if (corpus.size() - i < dmerLength) {
+                dmers.push_back(invalidDmer);
+                continue;
+            }
+            uint64_t hash = 0;
+            for (uint32_t k = 0; k < dmerLength; ++k) {
+                hash = (hash ^ static_cast<std::make_unsigned_t<charType>>(corpus[i + k])) * 0x100000001B3ull;
+            }
+            hash = std::min(hash, invalidDmer - 1);
+            dmers.push_back(hash);
+            if (!seen[hash]) {
+                seen[hash] = true;
+                ++frequencies[hash];
+            }
+        }
+    }
+
+    for (auto& frequency : frequencies) {
+        if (frequency.second < 2) frequency.second = 0;
+    }
+    frequencies[invalidDmer] = 0;
+
+    const size_t epochsCount = std::max<size_t>(1, std::min<size_t>(dictionarySize / segmentLength, corpus.size() / segmentLength));
+    const size_t epochLength = corpus.size() / epochsCount;
+
+    std::vector<size_t> selected;
+    size_t selectedLength = 0;
+    bool progress = true;
+    while ((selectedLength < dictionarySize) && progress) {
+        progress = false;
+        for (size_t epoch = 0; (epoch < epochsCount) && (selectedLength < dictionarySize); ++epoch) {
+            const size_t epochBegin = epoch * epochLength;
+            const size_t epochEnd = (epoch + 1 == epochsCount) ? corpus.size() : epochBegin + epochLength;
+            const segment best = findSegment(dmers, frequencies, epochBegin, epochEnd);
+            if (best.score == 0) continue;
+
+            selected.push_back(best.begin);
+            selectedLength += std::min<size_t>(segmentLength, corpus.size() - best.begin);
+            for (size_t i = best.begin; i < std::min<size_t>(best.begin + segmentLength, corpus.size()); ++i) {
+                frequencies[dmers[i]] = 0;
+            }
+            progress = true;
+        }
+    }
+
+    std::vector<charType> symbols;
+    for (size_t k = selected.size(); k-- > 0;) {
+        symbols.insert(symbols.end(), corpus.begin() + selected[k], corpus.begin() + std::min<size_t>(selected[k] + segmentLength, corpus.size()));
+    }
+
+    const size_t skipped = symbols.size() - std::min<size_t>(symbols.size(), dictionarySize);
+    StringL<charType> dictionary(symbols.size() - skipped);
+    for (size_t i = skipped; i < symbols.size(); ++i) {
+        dictionary.push_back(symbols[i]);
+    }
+
+    return dictionary;
+}
+
+template <typename charType>
+typename LZ77Dictionary<charType>::segment LZ77Dictionary<charType>::findSegment(const std::vector<uint64_t>& dmers,
+    const std::unordered_map<uint64_t, uint32_t>& frequencies, const size_t begin, const size_t end)
+{
+    segment best = { begin, 0 };
+    segment current = { begin, 0 };
+    std::unordered_map<uint64_t, uint32_t> active;
+
+    for (size_t i = begin; i < end; ++i) {
+        if (active[dmers[i]]++ == 0) {
+            current.score += frequencies.at(dmers[i]);
+        }
+        if (i + 1 - current.begin > segmentLength) {
+            if (--active[dmers[current.begin]] == 0) {
+                current.score -= frequencies.at(dmers[current.begin]);
+            }
+            ++current.begin;
+        }
+        if (current.score > best.score) {
+            best = current;
+        }
+    }
+
+    return best;
+}
+
+template <typename charType>
+uint32_t LZ77Dictionary<charType>::computeId(const StringL<charType>& dictionary)
+{
+    uint32_t hash = 0x811C9DC5;
+    for (const charType& c : dictionary) {
+        hash = (hash ^ static_cast<uint32_t>(static_cast<std::make_unsigned_t<charType>>(c))) * 0x01000193;
+    }
+    return (hash != 0) ? hash : 1;
+}
+
+template <typename charType>
+uint32_t LZ77Dictionary<charType>::Register(const StringL<charType>& dictionary)
+{
+    if (dictionary.size() < 1) return 0;
+
+    const uint32_t id = computeId(dictionary);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto registered = dictionaries.find(id);
+    if (registered == dictionaries.end()) {
+        dictionaries.emplace(id, dictionary);
+    } else if ((registered->second.size() != dictionary.size()) ||
+        !std::equal(dictionary.begin(), dictionary.end(), registered->second.begin())) {
+        throw std::runtime_error("LZ77Dictionary error: dictionary id collision");
+    }
+    return id;
+}
+
+template <typename charType>
+const StringL<charType>& LZ77Dictionary<charType>::Get(const uint32_t id)
+{
+    static const StringL<charType> empty;
+    if (id == 0) return empty;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto registered = dictionaries.find(id);
+    if (registered == dictionaries.end()) {
+        throw std::runtime_error("LZ77Dictionary error: unknown dictionary id");
+    }
+    return registered->second;
+}
\ No newline at end of file
@@ -0,0 +1,401 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+#include <type_traits>
+
+template <typename charType>
+class MatchFinder
+{
+public:
+    struct match {
+        uint32_t length;
+        uint32_t offset;
+    };
+
+    const static uint32_t hashedMatchLength = 3;
+
+    static uint32_t MatchLength(const charType* a, const charType* b, const uint32_t limit);
+protected:
+    const static uint32_t hashBits = 16;
+    const static uint32_t shortHashBits = 12;
+    const static uint32_t emptyPosition = UINT32_MAX;
+    const static size_t symbolsPerWord = sizeof(uint64_t) / sizeof(charType);
+
+    const charType* text;
+    size_t textLength;
+    uint32_t windowSize;
+    uint32_t maxMatchLength;
+    uint32_t minMatchLength;
+    std::vector<uint32_t> head;
+    std::vector<uint32_t> shortHeads[hashedMatchLength - 1];
+
+    MatchFinder(const charType* text, const size_t textLength, const uint32_t windowSize, const uint32_t maxMatchLength, const uint32_t minMatchLength);
+
+    static uint32_t hash(const charType* symbols);
+    static uint32_t shortHash(const charType* symbols, const uint32_t length);
+    void insertShort(const size_t position);
+    match findShortMatch(const size_t position, const uint32_t limit);
+};
+
+template <typename charType>
+class HashChainMatchFinder : public MatchFinder<charType>
+{
+public:
+    typedef typename MatchFinder<charType>::match match;
+
+    HashChainMatchFinder(const charType* text, const size_t textLength, const uint32_t windowSize, const uint32_t maxMatchLength,
+        const uint32_t chainDepth, const uint32_t minMatchLength = MatchFinder<charType>::hashedMatchLength);
+
+    match FindMatch(const size_t position);
+    void Insert(const size_t position);
+    void Skip(const size_t position, const size_t count);
+private:
+    typedef MatchFinder<charType> base;
+
+    uint32_t chainDepth;
+    size_t chainMask;
+    std::vector<uint32_t> chain;
+};
+
+template <typename charType>
+class BinaryTreeMatchFinder : public MatchFinder<charType>
+{
+public:
+    typedef typename MatchFinder<charType>::match match;
+
+    BinaryTreeMatchFinder(const charType* text, const size_t textLength, const uint32_t windowSize, const uint32_t maxMatchLength,
+        const uint32_t searchDepth, const uint32_t minMatchLength = MatchFinder<charType>::hashedMatchLength);
+
+    void GetMatches(const size_t position, std::vector<match>& matches);
+    void Skip(const size_t position, const size_t count);
+private:
+    typedef MatchFinder<charType> base;
+
+    uint32_t searchDepth;
+    size_t cyclicSize;
+    std::vector<uint32_t> children;
+
+    void update(const size_t position, std::vector<match>* matches);
+};
+
+template <typename charType>
+class LongDistanceMatchFinder
+{
+public:
+    struct match {
+        size_t position;
+        uint32_t length;
+        uint32_t offset;
+    };
+
+    const static uint32_t minMatchLength = 64;
+
+    LongDistanceMatchFinder(const charType* text, const size_t textLength, const uint32_t windowSize);
+
+    std::vector<match> FindMatches(const uint32_t minOffset);
+private:
+    const static uint32_t hashBits = 20;
+    const static uint32_t sampleBits = 4;
+    const static uint32_t emptyPosition = UINT32_MAX;
+    const static uint64_t hashMultiplier = 0x100000001B3ull;
+
+    const charType* text;
+    size_t textLength;
+    uint32_t windowSize;
+    uint64_t outgoingFactor;
+    std::vector<uint32_t> table;
+
+    static uint64_t symbol(const charType c) { return static_cast<std::make_unsigned_t<charType>>(c) + uint64_t(1); }
+    uint64_t hash(const size_t position) const;
+};
+
+template <typename charType>
+MatchFinder<charType>::MatchFinder(const charType* text, const size_t textLength, const uint32_t windowSize, const uint32_t maxMatchLength, const uint32_t minMatchLength) :
+    text(text), textLength(textLength), windowSize((windowSize < textLength) ? windowSize : static_cast<uint32_t>(textLength)), maxMatchLength(maxMatchLength),
+    minMatchLength((minMatchLength < 1) ? 1 : (minMatchLength > hashedMatchLength) ? hashedMatchLength : minMatchLength),
+    head(size_t(1) << hashBits, uint32_t(emptyPosition))
+{
+    for (uint32_t length = this->minMatchLength; length < hashedMatchLength; ++length) {
+        shortHeads[length - 1].assign(size_t(1) << shortHashBits, uint32_t(emptyPosition));
+    }
+}
+
+template <typename charType>
+HashChainMatchFinder<charType>::HashChainMatchFinder(const charType* text, const size_t textLength, const uint32_t windowSize, const uint32_t maxMatchLength,
+    const uint32_t chainDepth, const uint32_t minMatchLength) :
+    base(text, textLength, windowSize, maxMatchLength, minMatchLength), chainDepth(chainDepth)
+{
+    size_t chainSize = 1;
+    while (chainSize < base::windowSize + size_t(1)) chainSize <<= 1;
+    chainMask = chainSize - 1;
+    chain.assign(chainSize, uint32_t(base::emptyPosition));
+}
+
+template <typename charType>
+typename HashChainMatchFinder<charType>::match HashChainMatchFinder<charType>::FindMatch(const size_t position)
+{
+    const charType* text = base::text;
+    match best = { 0, 0 };
+    if (position >= base::textLength) return best;
+
+    const uint32_t limit = static_cast<uint32_t>(std::min<size_t>(base::maxMatchLength, base::textLength - position));
+    const bool shortMatches = base::minMatchLength < base::hashedMatchLength;
+    if (position + base::hashedMatchLength > base::textLength) {
+        return shortMatches ? base::findShortMatch(position, limit) : best;
+    }
+
+    const uint32_t h = base::hash(text + position);
+    uint32_t candidate = base::head[h];
+    chain[position & chainMask] = candidate;
+    base::head[h] = static_cast<uint32_t>(position);
+
+    for (uint32_t depth = 0; (depth < chainDepth) && (candidate != base::emptyPosition); ++depth) {
+        const size_t distance = position - candidate;
+        if ((distance == 0) || (distance > base::windowSize)) break;
+
+        if (text[candidate + best.length] == text[position + best.length]) {
+            const uint32_t length = base::MatchLength(text + candidate, text + position, limit);
+            if (length > best.length) {
+                best = { length, static_cast<uint32_t>(distance) };
+                if (length == limit) break;
+            }
+        }
+
+        const uint32_t next = chain[candidate & chainMask];
+        if ((next == base::emptyPosition) || (next >= candidate)) break;
+        candidate = next;
+    }
+
+    if (best.length < base::hashedMatchLength) {
+        return shortMatches ? base::findShortMatch(position, limit) : match{ 0, 0 };
+    }
+    base::insertShort(position);
+    return best;
+}
+
+template <typename charType>
+void HashChainMatchFinder<charType>::Insert(const size_t position)
+{
+    base::insertShort(position);
+    if (position + base::hashedMatchLength > base::textLength) return;
+
+    const uint32_t h = base::hash(base::text + position);
+    chain[position & chainMask] = base::head[h];
+    base::head[h] = static_cast<uint32_t>(position);
+}
+
+template <typename charType>
+void HashChainMatchFinder<charType>::Skip(const size_t position, const size_t count)
+{
+    for (size_t i = position; i < position + count; ++i) {
+        Insert(i);
+    }
+}
+
+template <typename charType>
+BinaryTreeMatchFinder<charType>::BinaryTreeMatchFinder(const charType* text, const size_t textLength, const uint32_t windowSize, const uint32_t maxMatchLength,
+    const uint32_t searchDepth, const uint32_t minMatchLength) :
+    base(text, textLength, windowSize, maxMatchLength, minMatchLength), searchDepth(searchDepth),
+    cyclicSize(size_t(base::windowSize) + 1), children(2 * cyclicSize, uint32_t(base::emptyPosition)) {}
+
+template <typename charType>
+void BinaryTreeMatchFinder<charType>::GetMatches(const size_t position, std::vector<match>& matches)
+{
+    matches.clear();
+    if (position >= base::textLength) return;
+
+    const uint32_t limit = static_cast<uint32_t>(std::min<size_t>(base::maxMatchLength, base::textLength - position));
+    if (base::minMatchLength < base::hashedMatchLength) {
+        const match shortMatch = base::findShortMatch(position, std::min<uint32_t>(limit, base::hashedMatchLength - 1));
+        if (shortMatch.length > 0) matches.push_back(shortMatch);
+    }
+    update(position, &matches);
+}
+
+template <typename charType>
+void BinaryTreeMatchFinder<charType>::Skip(const size_t position, const size_t count)
+{
+    for (size_t i = position; i < position + count; ++i) {
+        base::insertShort(i);
+        update(i, nullptr);
+    }
+}
+
+template <typename charType>
+void BinaryTreeMatchFinder<charType>::update(const size_t position, std::vector<match>* matches)
+{
+    const charType* text = base::text;
+    if (position + base::hashedMatchLength > base::textLength) return;
+
+    const uint32_t limit = static_cast<uint32_t>(std::min<size_t>(base::maxMatchLength, base::textLength - position));
+    const uint32_t h = base::hash(text + position);
+    uint32_t candidate = base::head[h];
+    base::head[h] = static_cast<uint32_t>(position);
+
+    uint32_t* left = &children[2 * (position % cyclicSize)];
+    uint32_t* right = left + 1;
+    uint32_t leftLength = 0, rightLength = 0;
+    uint32_t bestLength = (matches != nullptr && !matches->empty()) ? matches->back().length : 0;
+
+    for (uint32_t depth = 0; ; ++depth) {
+        const size_t distance = position - candidate;
+        if ((candidate == base::emptyPosition) || (distance == 0) || (distance > base::windowSize) || (depth >= searchDepth)) {
+            *left = *right = base::emptyPosition;
+            return;
+        }
+
+        uint32_t* pair = &children[2 * (candidate % cyclicSize)];
+        uint32_t length = std::min(leftLength, rightLength);
+        length += base::MatchLength(text + candidate + length, text + position + length, limit - length);
+
+        if ((matches != nullptr) && (length > bestLength)) {
+            bestLength = length;
+            matches->push_back({ length, static_cast<uint32_t>(distance) });
+        }
+        if (length == limit) {
+            *left = pair[0];
+            *right = pair[1];
+            return;
+        }
+
+        if (text[candidate + length] < text[position + length]) {
+            *left = candidate;
+            left = pair + 1;
+            candidate = *left;
+            leftLength = length;
+        } else {
+            *right = candidate;
+            right = pair;
+            candidate = *right;
+            rightLength = length;
+        }
+    }
+}
+
+template <typename charType>
+void MatchFinder<charType>::insertShort(const size_t position)
+{
+    for (uint32_t length = minMatchLength; (length < hashedMatchLength) && (position + length <= textLength); ++length) {
+        shortHeads[length - 1][shortHash(text + position, length)] = static_cast<uint32_t>(position);
+    }
+}
+
+template <typename charType>
+typename MatchFinder<charType>::match MatchFinder<charType>::findShortMatch(const size_t position, const uint32_t limit)
+{
+    match best = { 0, 0 };
+    for (uint32_t length = hashedMatchLength - 1; (length >= minMatchLength) && (best.length == 0); --length) {
+        if (length > limit) continue;
+
+        const uint32_t candidate = shortHeads[length - 1][shortHash(text + position, length)];
+        if ((candidate != emptyPosition) && (position - candidate <= windowSize)) {
+            const uint32_t matchLength = MatchLength(text + candidate, text + position, limit);
+            if (matchLength >= length) {
+                best = { matchLength, static_cast<uint32_t>(position - candidate) };
+            }
+        }
+    }
+
+    insertShort(position);
+    return best;
+}
+
+template <typename charType>
+uint32_t MatchFinder<charType>::MatchLength(const charType* a, const charType* b, const uint32_t limit)
+{
+    uint32_t length = 0;
+    if (symbolsPerWord > 1) {
+        while (length + symbolsPerWord <= limit) {
+            uint64_t wordA, wordB;
+            std::memcpy(&wordA, a + length, sizeof(uint64_t));
+            std::memcpy(&wordB, b + length, sizeof(uint64_t));
+            if (wordA != wordB) break;
+            length += static_cast<uint32_t>(symbolsPerWord);
+        }
+    }
+    while ((length < limit) && (a[length] == b[length])) ++length;
+    return length;
+}
+
+template <typename charType>
+uint32_t MatchFinder<charType>::hash(const charType* symbols)
+{
+    const uint32_t value = static_cast<uint32_t>(symbols[0]) * 0x9E3779B1u
+        ^ static_cast<uint32_t>(symbols[1]) * 0x85EBCA77u
+        ^ static_cast<uint32_t>(symbols[2]) * 0xC2B2AE3Du;
+    return (value ^ (value >> 15)) >> (32 - hashBits);
+}
+
+template <typename charType>
+uint32_t MatchFinder<charType>::shortHash(const charType* symbols, const uint32_t length)
+{
+    uint32_t value = static_cast<uint32_t>(symbols[0]) * 0x9E3779B1u;
+    if (length > 1) value ^= static_cast<uint32_t>(symbols[1]) * 0x85EBCA77u;
+    return (value ^ (value >> 15)) >> (32 - shortHashBits);
+}
+
+template <typename charType>
+LongDistanceMatchFinder<charType>::LongDistanceMatchFinder(const charType* text, const size_t textLength, const uint32_t windowSize) :
+    text(text), textLength(textLength), windowSize(windowSize), outgoingFactor(1), table(size_t(1) << hashBits, uint32_t(emptyPosition))
+{
+    for (uint32_t k = 0; k < minMatchLength; ++k) {
+        outgoingFactor *= hashMultiplier;
+    }
+}
+
+template <typename charType>
+uint64_t LongDistanceMatchFinder<charType>::hash(const size_t position) const
+{
+    uint64_t value = 0;
+    for (uint32_t k = 0; k < minMatchLength; ++k) {
+        value = value * hashMultiplier + symbol(text[position + k]);
+    }
+    return value;
+}
+
+template <typename charType>
+std::vector<typename LongDistanceMatchFinder<charType>::match> LongDistanceMatchFinder<charType>::FindMatches(const uint32_t minOffset)
+{
+    std::vector<match> matches;
+    if (textLength < minMatchLength) return matches;
+
+    size_t matchedEnd = 0;
+    uint64_t value = hash(0);
+    for (size_t i = 0; ; ) {
+        const uint64_t mixed = value * 0x9E3779B97F4A7C15ull;
+        if (((mixed >> 32) & ((uint64_t(1) << sampleBits) - 1)) == 0) {
+            uint32_t& slot = table[mixed >> (64 - hashBits)];
+            const uint32_t candidate = slot;
+            slot = static_cast<uint32_t>(i);
+
+            if ((candidate != emptyPosition) && (i - candidate >= minOffset) && (i - candidate <= windowSize)) {
+                uint32_t length = MatchFinder<charType>::MatchLength(text + candidate, text + i, static_cast<uint32_t>(std::min<size_t>(textLength - i, UINT32_MAX)));
+                if (length >= minMatchLength) {
+                    size_t start = i;
+                    size_t source = candidate;
+                    while ((start > matchedEnd) && (source > 0) && (text[start - 1] == text[source - 1]) && (length < UINT32_MAX)) {
+                        --start;
+                        --source;
+                        ++length;
+                    }
+                    matches.push_back({ start, length, static_cast<uint32_t>(i - candidate) });
+
+                    i = matchedEnd = start + length;
+                    if (i + minMatchLength > textLength) break;
+                    value = hash(i);
+                    continue;
+                }
+            }
+        }
+
+        if (i + minMatchLength >= textLength) break;
+        value = value * hashMultiplier - outgoingFactor * symbol(text[i]) + symbol(text[i + minMatchLength]);
+        ++i;
+    }
+
+    return matches;
+}
\ No newline at end of file
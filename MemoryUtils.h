@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+class MemoryUtils
+{
+public:
+    const static size_t wildCopyLength = 16;
+    const static size_t wildCopySlack = 2 * wildCopyLength;
+
+    static void WildCopy(void* destination, const void* source, const size_t bytes);
+
+    template <typename T>
+    static void CopyMatch(T* destination, const size_t offset, const size_t length, const size_t capacity);
+private:
+    MemoryUtils() = default;
+};
+
+inline void MemoryUtils::WildCopy(void* destination, const void* source, const size_t bytes)
+{
+    uint8_t* output = static_cast<uint8_t*>(destination);
+    const uint8_t* input = static_cast<const uint8_t*>(source);
+    uint8_t* const end = output + bytes;
+    do {
+        std::memcpy(output, input, wildCopyLength);
+        std::memcpy(output + wildCopyLength, input + wildCopyLength, wildCopyLength);
+        output += wildCopySlack;
+        input += wildCopySlack;
+    } while (output < end);
+}
+
+template <typename T>
+void MemoryUtils::CopyMatch(T* destination, const size_t offset, const size_t length, const size_t capacity)
+{
+    const T* source = destination - offset;
+    if ((offset * sizeof(T) >= wildCopySlack) && ((capacity - length) * sizeof(T) >= wildCopySlack)) {
+        WildCopy(destination, source, length * sizeof(T));
+        return;
+    }
+
+    size_t period = offset;
+    size_t remaining = length;
+    while (remaining > period) {
+        std::memcpy(destination, source, period * sizeof(T));
+        destination += period;
+        remaining -= period;
+        period *= 2;
+    }
+    std::memcpy(destination, source, remaining * sizeof(T));
+}
\ No newline at end of file
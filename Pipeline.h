@@ -0,0 +1,402 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "../helpers/FileUtils.h"
+#include "../helpers/CodecUTF8.h"
+#include "../helpers/StringL.h"
+#include "../helpers/Array.h"
+
+#include "CodecBWT.h"
+#include "CodecMTF.h"
+#include "CodecRLE.h"
+#include "CodecHA.h"
+#include "CodecAC.h"
+#include "CodecANS.h"
+#include "CodecCM.h"
+
+template <typename charType, template <typename> class... stageTypes>
+class Pipeline
+{
+    static_assert(sizeof...(stageTypes) > 0, "Pipeline needs at least one stage");
+public:
+    static void Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8);
+    static StringL<charType> Decode(std::ifstream& inputFile, const bool useUTF8);
+
+    const static size_t stagesCount = sizeof...(stageTypes);
+
+    struct chunk {
+        StringL<charType> buffer;
+        std::tuple<typename stageTypes<charType>::header...> headers;
+    };
+
+    template <size_t index, typename bufferType>
+    static void EncodeStage(const bufferType& input, chunk& chunk);
+    template <typename bufferType>
+    static void WriteChunk(const bufferType& input, chunk& chunk, std::ofstream& outputFile, const bool useUTF8);
+    static void ReadChunk(std::ifstream& inputFile, chunk& chunk, const bool useUTF8);
+    template <size_t index>
+    static void DecodeStage(chunk& chunk);
+protected:
+    Pipeline() = default;
+private:
+    template <size_t index>
+    using stage = typename std::tuple_element<index, std::tuple<stageTypes<charType>...>>::type;
+
+    template <size_t index>
+    static void encodeFrom(chunk& chunk, std::ofstream& outputFile, const bool useUTF8);
+    template <size_t index>
+    static void decodeFrom(chunk& chunk);
+    template <size_t index>
+    static void writeHeaders(const chunk& chunk, std::ofstream& outputFile, const bool useUTF8);
+    template <size_t index>
+    static void readHeaders(std::ifstream& inputFile, chunk& chunk, const bool useUTF8);
+
+    static void report(const char* name) { std::cout << "\t" << name << " done." << std::endl; }
+};
+
+template <typename charType>
+struct StageBWT : CodecBWT<charType>
+{
+    static const char* name() { return "BWT"; }
+
+    struct header {
+        uint32_t index;
+    };
+
+    static StringL<charType> encode(const StringL<charType>& inputStr, header& header);
+    static StringL<charType> decode(StringL<charType>& buffer, const header& header);
+    static void writeHeader(std::ofstream& outputFile, const header& header, const bool useUTF8);
+    static void readHeader(std::ifstream& inputFile, header& header, const bool useUTF8);
+};
+
+template <typename charType>
+struct StageMTF : CodecMTF<charType>
+{
+    static const char* name() { return "MTF"; }
+
+    struct header {
+        uint32_t alphabetLength;
+        Array<charType> alphabet;
+    };
+
+    static StringL<charType> encode(const StringL<charType>& inputStr, header& header);
+    static StringL<charType> decode(StringL<charType>& buffer, const header& header);
+    static void writeHeader(std::ofstream& outputFile, const header& header, const bool useUTF8);
+    static void readHeader(std::ifstream& inputFile, header& header, const bool useUTF8);
+};
+
+template <typename charType>
+struct StageRLE : CodecRLE<charType>
+{
+    static const char* name() { return "RLE"; }
+
+    struct header {};
+
+    static StringL<charType> encode(const StringL<charType>& inputStr, header& header);
+    static StringL<charType> decode(StringL<charType>& buffer, const header& header);
+    static void writeHeader(std::ofstream&, const header&, const bool) {}
+    static void readHeader(std::ifstream&, header&, const bool) {}
+
+    using CodecRLE<charType>::encodeToData;
+    using CodecRLE<charType>::encodeData;
+    static StringL<charType> decodeFrom(std::ifstream& inputFile, const bool useUTF8) { return CodecRLE<charType>::Decode(inputFile, useUTF8); }
+};
+
+template <typename charType>
+struct StageMTFRLE : CodecMTF<charType>, CodecRLE<charType>
+{
+    static const char* name() { return "MTF+RLE"; }
+
+    using header = typename StageMTF<charType>::header;
+
+    static StringL<charType> encode(const StringL<charType>& inputStr, header& header);
+    static StringL<charType> decode(StringL<charType>& buffer, const header& header);
+    static void writeHeader(std::ofstream& outputFile, const header& header, const bool useUTF8) { StageMTF<charType>::writeHeader(outputFile, header, useUTF8); }
+    static void readHeader(std::ifstream& inputFile, header& header, const bool useUTF8) { StageMTF<charType>::readHeader(inputFile, header, useUTF8); }
+};
+
+template <typename charType>
+struct StageHA : CodecHA<charType>
+{
+    static const char* name() { return "HA"; }
+
+    struct header {};
+
+    using CodecHA<charType>::encodeToData;
+    using CodecHA<charType>::encodeData;
+    static StringL<charType> decodeFrom(std::ifstream& inputFile, const bool useUTF8) { return CodecHA<charType>::Decode(inputFile, useUTF8); }
+};
+
+template <typename charType>
+struct StageAC : CodecAC<charType>
+{
+    static const char* name() { return "AC"; }
+
+    struct header {};
+
+    using CodecAC<charType>::encodeToData;
+    using CodecAC<charType>::encodeData;
+    static StringL<charType> decodeFrom(std::ifstream& inputFile, const bool useUTF8) { return CodecAC<charType>::Decode(inputFile, useUTF8); }
+};
+
+template <typename charType>
+struct StageANS : CodecANS<charType>
+{
+    static const char* name() { return "ANS"; }
+
+    struct header {};
+
+    using CodecANS<charType>::encodeToData;
+    using CodecANS<charType>::encodeData;
+    static StringL<charType> decodeFrom(std::ifstream& inputFile, const bool useUTF8) { return CodecANS<charType>::Decode(inputFile, useUTF8); }
+};
+
+template <typename charType>
+struct StageCM : CodecCM<charType>
+{
+    static const char* name() { return "CM"; }
+
+    struct header {};
+
+    using CodecCM<charType>::encodeToData;
+    using CodecCM<charType>::encodeData;
+    static StringL<charType> decodeFrom(std::ifstream& inputFile, const bool useUTF8) { return CodecCM<charType>::Decode(inputFile, useUTF8); }
+};
+
+template <typename charType, template <typename> class... stageTypes>
+void Pipeline<charType, stageTypes...>::Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8)
+{
+    chunk chunk;
+    if constexpr (stagesCount > 1) {
+        EncodeStage<0>(inputStr, chunk);
+        report(stage<0>::name());
+        encodeFrom<1>(chunk, outputFile, useUTF8);
+    } else {
+        WriteChunk(inputStr, chunk, outputFile, useUTF8);
+        report(stage<0>::name());
+    }
+}
+
+template <typename charType, template <typename> class... stageTypes>
+StringL<charType> Pipeline<charType, stageTypes...>::Decode(std::ifstream& inputFile, const bool useUTF8)
+{
+    chunk chunk;
+    ReadChunk(inputFile, chunk, useUTF8);
+    report(stage<stagesCount - 1>::name());
+    decodeFrom<stagesCount - 1>(chunk);
+    return std::move(chunk.buffer);
+}
+
+template <typename charType, template <typename> class... stageTypes>
+template <size_t index, typename bufferType>
+void Pipeline<charType, stageTypes...>::EncodeStage(const bufferType& input, chunk& chunk)
+{
+    static_assert(index + 1 < stagesCount, "the last stage is written by WriteChunk");
+    chunk.buffer = stage<index>::encode(input, std::get<index>(chunk.headers));
+}
+
+template <typename charType, template <typename> class... stageTypes>
+template <typename bufferType>
+void Pipeline<charType, stageTypes...>::WriteChunk(const bufferType& input, chunk& chunk, std::ofstream& outputFile, const bool useUTF8)
+{
+    const auto data = stage<stagesCount - 1>::encodeToData(input);
+    chunk.buffer.free_memory();
+    stage<stagesCount - 1>::encodeData(outputFile, data, useUTF8);
+    writeHeaders<stagesCount - 1>(chunk, outputFile, useUTF8);
+}
+
+template <typename charType, template <typename> class... stageTypes>
+void Pipeline<charType, stageTypes...>::ReadChunk(std::ifstream& inputFile, chunk& chunk, const bool useUTF8)
+{
+    chunk.buffer = stage<stagesCount - 1>::decodeFrom(inputFile, useUTF8);
+    readHeaders<stagesCount - 1>(inputFile, chunk, useUTF8);
+}
+
+template <typename charType, template <typename> class... stageTypes>
+template <size_t index>
+void Pipeline<charType, stageTypes...>::DecodeStage(chunk& chunk)
+{
+    static_assert(index + 1 < stagesCount, "the last stage is read by ReadChunk");
+    chunk.buffer = stage<index>::decode(chunk.buffer, std::get<index>(chunk.headers));
+}
+
+template <typename charType, template <typename> class... stageTypes>
+template <size_t index>
+void Pipeline<charType, stageTypes...>::encodeFrom(chunk& chunk, std::ofstream& outputFile, const bool useUTF8)
+{
+    if constexpr (index + 1 < stagesCount) {
+        EncodeStage<index>(chunk.buffer, chunk);
+        report(stage<index>::name());
+        encodeFrom<index + 1>(chunk, outputFile, useUTF8);
+    } else {
+        WriteChunk(chunk.buffer, chunk, outputFile, useUTF8);
+        report(stage<index>::name());
+    }
+}
+
+template <typename charType, template <typename> class... stageTypes>
+template <size_t index>
+void Pipeline<charType, stageTypes...>::decodeFrom(chunk& chunk)
+{
+    if constexpr (index > 0) {
+        DecodeStage<index - 1>(chunk);
+        report(stage<index - 1>::name());
+        decodeFrom<index - 1>(chunk);
+    }
+}
+
+template <typename charType, template <typename> class... stageTypes>
+template <size_t index>
+void Pipeline<charType, stageTypes...>::writeHeaders(const chunk& chunk, std::ofstream& outputFile, const bool useUTF8)
+{
+    if constexpr (index > 0) {
+        stage<index - 1>::writeHeader(outputFile, std::get<index - 1>(chunk.headers), useUTF8);
+        writeHeaders<index - 1>(chunk, outputFile, useUTF8);
+    }
+}
+
+template <typename charType, template <typename> class... stageTypes>
+template <size_t index>
+void Pipeline<charType, stageTypes...>::readHeaders(std::ifstream& inputFile, chunk& chunk, const bool useUTF8)
+{
+    if constexpr (index > 0) {
+        stage<index - 1>::readHeader(inputFile, std::get<index - 1>(chunk.headers), useUTF8);
+        readHeaders<index - 1>(inputFile, chunk, useUTF8);
+    }
+}
+
+template <typename charType>
+StringL<charType> StageBWT<charType>::encode(const StringL<charType>& inputStr, header& header)
+{
+    auto data = CodecBWT<charType>::encodeToData(inputStr);
+    header.index = data.index;
+    return std::move(data.encodedStr);
+}
+
+template <typename charType>
+StringL<charType> StageBWT<charType>::decode(StringL<charType>& buffer, const header& header)
+{
+    typename CodecBWT<charType>::data data;
+    data.index = header.index;
+    data.encodedStrLength = buffer.size();
+    data.encodedStr = std::move(buffer);
+    return CodecBWT<charType>::decodeData(data);
+}
+
+template <typename charType>
+void StageBWT<charType>::writeHeader(std::ofstream& outputFile, const header& header, const bool)
+{
+    FileUtils::AppendValueBinary(outputFile, header.index);
+}
+
+template <typename charType>
+void StageBWT<charType>::readHeader(std::ifstream& inputFile, header& header, const bool)
+{
+    header.index = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+}
+
+template <typename charType>
+StringL<charType> StageMTF<charType>::encode(const StringL<charType>& inputStr, header& header)
+{
+    StringL<charType> result(inputStr.size());
+    header.alphabet = CodecMTF<charType>::encodeCodes(inputStr, [&result](const uint32_t code) { result.push_back(static_cast<charType>(code)); });
+    header.alphabetLength = header.alphabet.size();
+    return result;
+}
+
+template <typename charType>
+StringL<charType> StageMTF<charType>::decode(StringL<charType>& buffer, const header& header)
+{
+    Array<charType> alphabet = header.alphabet;
+    StringL<charType> result(buffer.size());
+    for (const auto& c : buffer) {
+        result.push_back(CodecMTF<charType>::decodeCode(alphabet, static_cast<std::make_unsigned_t<charType>>(c)));
+    }
+    buffer.free_memory();
+    return result;
+}
+
+template <typename charType>
+void StageMTF<charType>::writeHeader(std::ofstream& outputFile, const header& header, const bool useUTF8)
+{
+    FileUtils::AppendValueBinary(outputFile, header.alphabetLength);
+    if (useUTF8) {
+        for (const charType c : header.alphabet)
+            CodecUTF8::EncodeCharToBinaryFile(outputFile, c);
+    } else {
+        for (const charType c : header.alphabet)
+            FileUtils::AppendValueBinary(outputFile, c);
+    }
+}
+
+template <typename charType>
+void StageMTF<charType>::readHeader(std::ifstream& inputFile, header& header, const bool useUTF8)
+{
+    header.alphabetLength = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    header.alphabet = Array<charType>(header.alphabetLength);
+    if (useUTF8) {
+        while (header.alphabet.size() < header.alphabetLength) {
+            header.alphabet.push_back(CodecUTF8::DecodeCharFromBinaryFile<charType>(inputFile));
+        }
+    } else {
+        while (header.alphabet.size() < header.alphabetLength) {
+            header.alphabet.push_back(FileUtils::ReadValueBinary<charType>(inputFile));
+        }
+    }
+}
+
+template <typename charType>
+StringL<charType> StageRLE<charType>::encode(const StringL<charType>& inputStr, header&)
+{
+    StringL<charType> result(inputStr.size());
+    auto consume = [&result](const int8_t number, const charType* chars, const size_t count) {
+        CodecRLE<charType>::appendToken(result, number, chars, count);
+    };
+    typename CodecRLE<charType>::template run_encoder<decltype(consume)> encoder(consume);
+    for (const auto& c : inputStr) {
+        encoder.push(c);
+    }
+    encoder.finish();
+    return result;
+}
+
+template <typename charType>
+StringL<charType> StageRLE<charType>::decode(StringL<charType>& buffer, const header&)
+{
+    StringL<charType> result(buffer.size());
+    CodecRLE<charType>::decodeTokens(buffer, [&result](const charType c) { result.push_back(c); });
+    buffer.free_memory();
+    return result;
+}
+
+template <typename charType>
+StringL<charType> StageMTFRLE<charType>::encode(const StringL<charType>& inputStr, header& header)
+{
+    StringL<charType> result(inputStr.size());
+    auto consume = [&result](const int8_t number, const charType* chars, const size_t count) {
+        CodecRLE<charType>::appendToken(result, number, chars, count);
+    };
+    typename CodecRLE<charType>::template run_encoder<decltype(consume)> encoder(consume);
+    header.alphabet = CodecMTF<charType>::encodeCodes(inputStr, [&encoder](const uint32_t code) { encoder.push(static_cast<charType>(code)); });
+    header.alphabetLength = header.alphabet.size();
+    encoder.finish();
+    return result;
+}
+
+template <typename charType>
+StringL<charType> StageMTFRLE<charType>::decode(StringL<charType>& buffer, const header& header)
+{
+    Array<charType> alphabet = header.alphabet;
+    StringL<charType> result(buffer.size());
+    CodecRLE<charType>::decodeTokens(buffer, [&](const charType c) {
+        result.push_back(CodecMTF<charType>::decodeCode(alphabet, static_cast<std::make_unsigned_t<charType>>(c)));
+    });
+    buffer.free_memory();
+    return result;
+}
\ No newline at end of file
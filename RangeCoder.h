@@ -0,0 +1,166 @@
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+#include <fstream>
+
+#include "../helpers/Array.h"
+
+class RangeEncoder
+{
+public:
+    explicit RangeEncoder(Array<uint8_t>& output) : output(output), low(0), range(0xFFFFFFFF), cache(0), cacheSize(1) {}
+
+    void Encode(const uint32_t cumulativeFrequency, const uint32_t frequency, const uint32_t totalFrequency);
+    void EncodeBit(const uint32_t probability, const int bit);
+    void Flush();
+private:
+    const static uint32_t topValue = 1 << 24;
+    const static uint32_t probabilityBits = 12;
+
+    Array<uint8_t>& output;
+    uint64_t low;
+    uint32_t range;
+    uint8_t cache;
+    uint64_t cacheSize;
+
+    void shiftLow();
+};
+
+class RangeDecoder
+{
+public:
+    RangeDecoder(const uint8_t* begin, const uint8_t* end);
+    explicit RangeDecoder(std::ifstream& inputFile);
+
+    uint32_t GetFrequency(const uint32_t totalFrequency);
+    void Decode(const uint32_t cumulativeFrequency, const uint32_t frequency);
+    int DecodeBit(const uint32_t probability);
+private:
+    const static uint32_t topValue = 1 << 24;
+    const static uint32_t probabilityBits = 12;
+
+    const uint8_t* current;
+    const uint8_t* end;
+    std::ifstream* inputFile;
+    uint32_t range;
+    uint32_t code;
+
+    void init();
+    uint8_t nextByte();
+};
+
+inline void RangeEncoder::Encode(const uint32_t cumulativeFrequency, const uint32_t frequency, const uint32_t totalFrequency)
+{
+    range /= totalFrequency;
+    low += static_cast<uint64_t>(cumulativeFrequency) * range;
+    range *= frequency;
+    while (range < topValue) {
+        range <<= 8;
+        shiftLow();
+    }
+}
+
+inline void RangeEncoder::EncodeBit(const uint32_t probability, const int bit)
+{
+    const uint32_t bound = (range >> probabilityBits) * probability;
+    if (bit) {
+        range = bound;
+    } else {
+        low += bound;
+        range -= bound;
+    }
+    while (range < topValue) {
+        range <<= 8;
+        shiftLow();
+    }
+}
+
+inline void RangeEncoder::Flush()
+{
+    for (int i = 0; i < 5; ++i) {
+        shiftLow();
+    }
+}
+
+inline void RangeEncoder::shiftLow()
+{
+    if ((static_cast<uint32_t>(low) < 0xFF000000) || ((low >> 32) != 0)) {
+        const uint8_t carry = static_cast<uint8_t>(low >> 32);
+        uint8_t pending = cache;
+        do {
+            output.push_back(static_cast<uint8_t>(pending + carry));
+            pending = 0xFF;
+        } while (--cacheSize != 0);
+        cache = static_cast<uint8_t>(low >> 24);
+    }
+    ++cacheSize;
+    low = (low & 0x00FFFFFF) << 8;
+}
+
+inline RangeDecoder::RangeDecoder(const uint8_t* begin, const uint8_t* end) : 
+    current(begin), end(end), inputFile(nullptr), range(0xFFFFFFFF), code(0)
+{
+    init();
+}
+
+inline RangeDecoder::RangeDecoder(std::ifstream& inputFile) : 
+    current(nullptr), end(nullptr), inputFile(&inputFile), range(0xFFFFFFFF), code(0)
+{
+    init();
+}
+
+inline void RangeDecoder::init()
+{
+    for (int i = 0; i < 5; ++i) {
+        code = (code << 8) | nextByte();
+    }
+}
+
+inline uint32_t RangeDecoder::GetFrequency(const uint32_t totalFrequency)
+{
+    range /= totalFrequency;
+    return std::min(code / range, totalFrequency - 1);
+}
+
+inline void RangeDecoder::Decode(const uint32_t cumulativeFrequency, const uint32_t frequency)
+{
+    code -= cumulativeFrequency * range;
+    range *= frequency;
+    while (range < topValue) {
+        code = (code << 8) | nextByte();
+        range <<= 8;
+    }
+}
+
+inline int RangeDecoder::DecodeBit(const uint32_t probability)
+{
+    const uint32_t bound = (range >> probabilityBits) * probability;
+    int bit;
+    if (code < bound) {
+        range = bound;
+        bit = 1;
+    } else {
+        code -= bound;
+        range -= bound;
+        bit = 0;
+    }
+    while (range < topValue) {
+        code = (code << 8) | nextByte();
+        range <<= 8;
+    }
+    return bit;
+}
+
+inline uint8_t RangeDecoder::nextByte()
+{
+    if (inputFile != nullptr) {
+        const int byte = inputFile->get();
+        if (byte == std::char_traits<char>::eof()) {
+            throw std::runtime_error("RangeDecoder error: unexpected end of file");
+        }
+        return static_cast<uint8_t>(byte);
+    }
+    return (current < end) ? *current++ : 0;
+}
\ No newline at end of file
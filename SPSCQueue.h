@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <utility>
+#include <vector>
+
+template <typename T>
+class SPSCQueue
+{
+public:
+    explicit SPSCQueue(const size_t capacity);
+
+    SPSCQueue(const SPSCQueue&) = delete;
+    SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+    bool Push(T&& item, const std::atomic<bool>& cancelled);
+    bool Pop(T& item, const std::atomic<bool>& cancelled);
+private:
+    const static size_t cacheLineSize = 64;
+    const static uint32_t spinsBeforeSleep = 64;
+
+    std::vector<T> slots;
+    size_t mask;
+    alignas(cacheLineSize) std::atomic<size_t> head{0};
+    alignas(cacheLineSize) std::atomic<size_t> tail{0};
+
+    static void wait(uint32_t& spins);
+};
+
+template <typename T>
+SPSCQueue<T>::SPSCQueue(const size_t capacity)
+{
+    size_t size = 1;
+    while (size < capacity) size <<= 1;
+    slots.resize(size);
+    mask = size - 1;
+}
+
+template <typename T>
+bool SPSCQueue<T>::Push(T&& item, const std::atomic<bool>& cancelled)
+{
+    const size_t position = tail.load(std::memory_order_relaxed);
+    for (uint32_t spins = 0; position - head.load(std::memory_order_acquire) == slots.size(); wait(spins)) {
+        if (cancelled.load(std::memory_order_relaxed)) return false;
+    }
+    slots[position & mask] = std::move(item);
+    tail.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+bool SPSCQueue<T>::Pop(T& item, const std::atomic<bool>& cancelled)
+{
+    const size_t position = head.load(std::memory_order_relaxed);
+    for (uint32_t spins = 0; position == tail.load(std::memory_order_acquire); wait(spins)) {
+        if (cancelled.load(std::memory_order_relaxed)) return false;
+    }
+    item = std::move(slots[position & mask]);
+    head.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+void SPSCQueue<T>::wait(uint32_t& spins)
+{
+    if (++spins < spinsBeforeSleep) {
+        std::this_thread::yield();
+    } else {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <fstream>
+#include <functional>
+#include <istream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+class StreamUtils
+{
+public:
+    template <typename charType>
+    static std::function<size_t(charType*, size_t)> SourceFrom(std::istream& input);
+    template <typename charType>
+    static size_t ReadChunk(const std::function<size_t(charType*, size_t)>& source, std::vector<charType>& buffer);
+    template <typename writerType>
+    static std::string CaptureOutput(const writerType& write);
+private:
+    StreamUtils() = default;
+};
+
+template <typename charType>
+std::function<size_t(charType*, size_t)> StreamUtils::SourceFrom(std::istream& input)
+{
+    return [&input](charType* symbols, const size_t count) {
+        input.read(reinterpret_cast<char*>(symbols), count * sizeof(charType));
+        const size_t received = static_cast<size_t>(input.gcount());
+        if (received % sizeof(charType) != 0) {
+            throw std::runtime_error("StreamUtils error: input ends inside a symbol");
+        }
+        return received / sizeof(charType);
+    };
+}
+
+template <typename charType>
+size_t StreamUtils::ReadChunk(const std::function<size_t(charType*, size_t)>& source, std::vector<charType>& buffer)
+{
+    size_t filled = 0;
+    while (filled < buffer.size()) {
+        const size_t received = source(buffer.data() + filled, buffer.size() - filled);
+        if (received < 1) break;
+        filled += received;
+    }
+    return filled;
+}
+
+template <typename writerType>
+std::string StreamUtils::CaptureOutput(const writerType& write)
+{
+    std::stringbuf bytes(std::ios::out | std::ios::binary);
+    std::ofstream output;
+    static_cast<std::ostream&>(output).rdbuf(&bytes);
+    write(output);
+    if (!output) {
+        throw std::runtime_error("StreamUtils error: failed to capture output");
+    }
+    return bytes.str();
+}
\ No newline at end of file
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstddef>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "CodecSettings.h"
+
+class ThreadPool
+{
+public:
+    explicit ThreadPool(const size_t threadsCount);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    static std::shared_ptr<ThreadPool> Shared();
+
+    size_t GetThreadsCount() const { return workers.size(); }
+    void Submit(std::function<void()> task);
+
+    template <typename function>
+    void ParallelFor(const size_t count, function&& body);
+private:
+    struct parallel_state {
+        std::function<void(size_t)> body;
+        size_t count;
+        std::atomic<size_t> next{0};
+        size_t done = 0;
+        std::exception_ptr error;
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable available;
+    bool stopping;
+
+    void work();
+
+    static void runIndices(parallel_state& state);
+};
+
+inline ThreadPool::ThreadPool(const size_t threadsCount) : stopping(false)
+{
+    for (size_t i = 0; i < threadsCount; ++i) {
+        workers.emplace_back(&ThreadPool::work, this);
+    }
+}
+
+inline ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    available.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+inline std::shared_ptr<ThreadPool> ThreadPool::Shared()
+{
+    static std::mutex sharedMutex;
+    static std::shared_ptr<ThreadPool> pool;
+
+    const size_t threadsCount = (CodecSettings::GetThreadsCount() > 1) ? CodecSettings::GetThreadsCount() - 1 : 0;
+    std::lock_guard<std::mutex> lock(sharedMutex);
+    if (!pool || (pool->GetThreadsCount() != threadsCount)) {
+        pool = std::make_shared<ThreadPool>(threadsCount);
+    }
+    return pool;
+}
+
+inline void ThreadPool::Submit(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push(std::move(task));
+    }
+    available.notify_one();
+}
+
+inline void ThreadPool::work()
+{
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            available.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (tasks.empty()) return;
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        task();
+    }
+}
+
+template <typename function>
+void ThreadPool::ParallelFor(const size_t count, function&& body)
+{
+    if (count < 1) return;
+
+    auto state = std::make_shared<parallel_state>();
+    state->body = std::forward<function>(body);
+    state->count = count;
+    const size_t helpersCount = std::min(workers.size(), count - 1);
+    for (size_t i = 0; i < helpersCount; ++i) {
+        Submit([state] { runIndices(*state); });
+    }
+    runIndices(*state);
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait(lock, [&state, count] { return state->done == count; });
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
+
+inline void ThreadPool::runIndices(parallel_state& state)
+{
+    for (size_t i = state.next++; i < state.count; i = state.next++) {
+        std::exception_ptr error;
+        try {
+            state.body(i);
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (error && !state.error) state.error = error;
+        if (++state.done == state.count) state.finished.notify_all();
+    }
+}
\ No newline at end of file